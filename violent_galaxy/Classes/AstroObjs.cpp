@@ -1,6 +1,5 @@
 #include "AstroObjs.h"
 #include "GameScene.h"
-#include <base/ccRandom.h>
 
 #include <unordered_set>
 
@@ -11,7 +10,8 @@ bool AstroObj::init(GameScene* game)
     VisualObj::init(game);
     auto body = _rootNode->getPhysicsBody();
     game->physicsWorld()->getForceField()->addGravitySource(body, body->getMass());
-    body->setDynamic(false);
+    // Units resting on kinematic bodies are never allowed to sleep, so make it static
+    body->setStatic(true);
     setZs(ZsAstroObjDefault);
     return true;
 }
@@ -21,15 +21,16 @@ ObjType AstroObj::getObjType()
     return ObjType::AstroObj;
 }
 
-Planet::Planet()
-    : _segments(360)
+void PlanetDesc::generate()
 {
+    Rng rng(seed);
+
     // Generate mountains
-    for (int i = 0; i < 100; i++) {
-        float height = random<float>(50.0f, 300.0f);
-        float slope = random<float>(4.0f, 12.0f);
+    for (size_t i = 0; i < mountainCount; i++) {
+        float height = rng.uniform(mountainHeight / 6, mountainHeight);
+        float slope = rng.uniform(4.0f, 12.0f);
         float width = std::min(180.0f, height / slope);
-        float longitude = random<float>(0.0, 360.0);
+        float longitude = rng.uniform(0.0f, 360.0f);
         for (size_t i = 0; i < width; i++) {
             float x = 0;
             if (i < width/2) {
@@ -37,7 +38,7 @@ Planet::Planet()
             } else {
                 x = (width - i) * 2 / width;
             }
-            Segment& s = *_segments.locateLng(longitude + i);
+            Segment& s = *segments.locateLng(longitude + i);
             GeoPoint& ms = s.pts.back();
             ms.altitude += x * height;
         }
@@ -47,9 +48,9 @@ Planet::Planet()
     std::unordered_set<Segment*> occupied;
     ui64 fails = 0;
     StratumId sid = 1;
-    for (int i = 0; i < 50; ) {
-        float lng = random<float>(0.0, 360.0);
-        Segment& seg = *_segments.locateLng(lng);
+    for (size_t i = 0; i < depositCount; ) {
+        float lng = rng.uniform(0.0f, 360.0f);
+        Segment& seg = *segments.locateLng(lng);
         if (occupied.find(&seg) != occupied.end()) {
             if (++fails > 1000) {
                 break;
@@ -64,8 +65,8 @@ Planet::Planet()
         seg.split(ptsCount);
 
         Res res(i % 2 == 0? Res::Ore: Res::Oil);
-        _deposits.push_back(Deposit());
-        Deposit& dep = _deposits.back();
+        deposits.push_back(Deposit());
+        Deposit& dep = deposits.back();
         dep.res = res;
         dep.resLeft = 2000;
         seg.deposits.push_back(&dep);
@@ -103,8 +104,32 @@ Planet::Planet()
         i++;
         sid++;
     }
+
+    // Crust polygon
+    crust.reserve(segments.size());
+    for (const Segment& seg : segments) {
+        for (const GeoPoint& pt : seg.pts) {
+            crust.push_back((coreRadius + pt.altitude) * Vec2::forAngle(pt.angle));
+        }
+    }
 }
 
+Planet* Planet::create(GameScene* game, PlanetDesc&& desc)
+{
+    Planet* pRet = new (std::nothrow) Planet();
+    if (pRet && pRet->init(game, std::move(desc))) {
+        pRet->autorelease();
+        return pRet;
+    } else {
+        delete pRet;
+        return nullptr;
+    }
+}
+
+Planet::Planet()
+    : _segments(0) // Terrain is taken from description by init()
+{}
+
 float Planet::getSize()
 {
     return _coreRadius * 1.5;
@@ -164,51 +189,145 @@ void Planet::addPlatform(Platform&& platform)
 
     _body->addShape(platform.shape, false);
     _platforms.push_back(platform);
-    draw();
+    drawChunk(getChunkIndex(platform.pts[0].getAngle()));
 }
 
-bool Planet::init(GameScene* game)
+bool Planet::init(GameScene* game, PlanetDesc&& desc)
 {
-    _coreRadius = 6000;
-    _surfAltitude = 100;
-    _atmoAltitude = 1500;
-    _spacAltitude = 6000;
-    fillCrust();
+    _coreRadius = desc.coreRadius;
+    _surfAltitude = desc.surfAltitude;
+    _atmoAltitude = desc.atmoAltitude;
+    _spacAltitude = desc.spacAltitude;
+    _mass = desc.mass;
+    _moment = desc.moment;
+    _segments = std::move(desc.segments);
+    _deposits = std::move(desc.deposits);
+    _crust = std::move(desc.crust);
+    _seed = desc.seed;
+    _geoPts.reserve(_crust.size());
+    for (const Segment& seg : _segments) {
+        for (const GeoPoint& pt : seg.pts) {
+            _geoPts.push_back(&pt);
+        }
+    }
     AstroObj::init(game);
+    setPosition(desc.position);
     return true;
 }
 
+// Atmosphere gradient and inner part of crust with decorations computed per pixel
+static const GLchar* planetFrag = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform vec4 u_radii; // Core, surface, atmosphere and space radii relative to space radius
+uniform float u_innerRadius; // Inner crust radius, outer crust is drawn by geometry
+uniform vec4 u_coreColor;
+uniform vec4 u_surfColor;
+uniform vec4 u_atmoColor;
+uniform vec4 u_spacColor;
+uniform vec4 u_crustColor;
+uniform vec3 u_spot1; // Center and radius of decoration spots inside crust
+uniform vec3 u_spot2;
+uniform vec3 u_spot3;
+uniform vec4 u_spot1Color;
+uniform vec4 u_spot2Color;
+uniform vec4 u_spot3Color;
+
+void main()
+{
+    vec2 p = vec2(v_texCoord.x * 2.0 - 1.0, 1.0 - v_texCoord.y * 2.0);
+    float r = length(p);
+    vec4 color;
+    if (r < u_innerRadius) {
+        color = u_crustColor;
+        if (distance(p, u_spot1.xy) < u_spot1.z) {
+            color = u_spot1Color;
+        }
+        if (distance(p, u_spot2.xy) < u_spot2.z) {
+            color = u_spot2Color;
+        }
+        if (distance(p, u_spot3.xy) < u_spot3.z) {
+            color = u_spot3Color;
+        }
+    } else if (r < u_radii.y) {
+        color = mix(u_coreColor, u_surfColor, clamp((r - u_radii.x) / (u_radii.y - u_radii.x), 0.0, 1.0));
+    } else if (r < u_radii.z) {
+        color = mix(u_surfColor, u_atmoColor, (r - u_radii.y) / (u_radii.z - u_radii.y));
+    } else if (r < u_radii.w) {
+        color = mix(u_atmoColor, u_spacColor, (r - u_radii.z) / (u_radii.w - u_radii.z));
+    } else {
+        discard;
+    }
+    gl_FragColor = color;
+}
+)";
+
+static GLProgram* planetProgram()
+{
+    static const char* key = "violent_galaxy.planet";
+    GLProgram* program = GLProgramCache::getInstance()->getGLProgram(key);
+    if (!program) {
+        program = GLProgram::createWithByteArrays(ccPositionTextureColor_noMVP_vert, planetFrag);
+        GLProgramCache::getInstance()->addGLProgram(program, key);
+    }
+    return program;
+}
+
 Node* Planet::createNodes()
 {
-    return DrawNode::create();
+    auto root = DrawNode::create();
+
+    // Whole default 2x2 white texture is used, so texture coords span [0; 1]
+    _atmoNode = Sprite::create();
+    _atmoNode->setTextureRect(Rect(0, 0, 2, 2));
+    _atmoNode->setScale(_coreRadius + _spacAltitude);
+    _atmoNode->setGLProgramState(GLProgramState::create(planetProgram()));
+    root->addChild(_atmoNode, -1); // Under crust
+
+    _chunks.resize(gPlanetChunks);
+    for (Chunk& chunk : _chunks) {
+        chunk.node = DrawNode::create();
+        root->addChild(chunk.node);
+        chunk.crust1 = chunk.crust2 = _crust.size();
+    }
+
+    // Crust points are ordered by angle, so every chunk has contiguous range of them
+    size_t ci = 0;
+    _chunks[0].crust1 = 0;
+    for (size_t i = 0; i < _crust.size(); i++) {
+        size_t cj = std::max(ci, getChunkIndex(_geoPts[i]->angle));
+        while (ci < cj) {
+            _chunks[ci].crust2 = i;
+            _chunks[++ci].crust1 = i;
+        }
+    }
+    _chunks[ci].crust2 = _crust.size();
+    return root;
 }
 
 PhysicsBody* Planet::createBody()
 {
     _body = PhysicsBody::create();
-    Vec2 vert[3];
-    vert[2] = Vec2::ZERO;
-    Vec2 c1 = _crust.back();
-    for (Vec2& c2 : _crust) {
-        vert[0] = c1;
-        vert[1] = c2;
-        _body->addShape(PhysicsShapePolygon::create(vert, 3, gPlanetMaterial), false);
-        c1 = c2;
+    for (Chunk& chunk : _chunks) {
+        buildChunkShapes(chunk);
     }
 //    PhysicsBody* body = PhysicsBody::createCircle(
 //        _coreRadius,
 //        gPlanetMaterial,
 //        Vec2::ZERO
 //    );
-    _body->setMass(1e10);
-    _body->setMoment(1e12);
+    _body->setMass(_mass);
+    _body->setMoment(_moment);
     return _body;
 }
 
 void Planet::draw()
 {
-    node()->clear();
-
     // Special hack to avoid drawing atmosphere and crust over units
     node()->setLocalZOrder(-10);
     _useZsForLocalZOrder = false;
@@ -218,78 +337,98 @@ void Planet::draw()
     Color4F surfCol = Color4F(0.0, 0.5, 0.9, 1.0);
     Color4F atmoCol = Color4F(0.0, 0.2, 0.8, 1.0);
     Color4F spacCol = Color4F::BLACK;
-    Color4F crustCol = Color4F(0.5f, 0.4f, 0.0f, 1.0f);
-    Color4F platformCol = Color4F(0.4f, 0.4f, 0.4f, 1.0f);
-
-    // Draw atmosphere gradient
-    auto prev = _segments.begin() + (_segments.size() - 1); // forward iter to last element
-    for (auto i = _segments.begin(), e = _segments.end(); i != e; ++i) {
-        float r1 = _coreRadius;
-        float r2 = r1 + _surfAltitude;
-        float r3 = r1 + _atmoAltitude;
-        float r4 = r1 + _spacAltitude;
-        float a1 = prev->a1;
-        float a2 = i->a1;
-        drawAtmoCell(r1, r2, a1, a2, coreCol, surfCol);
-        drawAtmoCell(r2, r3, a1, a2, surfCol, atmoCol);
-        drawAtmoCell(r3, r4, a1, a2, atmoCol, spacCol);
-        prev = i;
+    Color4F crustCol = gCrustColor;
+
+    // Atmosphere gradient and inner crust are drawn by shader
+    float r4 = _coreRadius + _spacAltitude;
+    float innerRadius = _coreRadius * gPlanetInnerCrust;
+    GLProgramState* state = _atmoNode->getGLProgramState();
+    state->setUniformVec4("u_radii", Vec4(
+        _coreRadius / r4,
+        (_coreRadius + _surfAltitude) / r4,
+        (_coreRadius + _atmoAltitude) / r4,
+        1.0f
+    ));
+    state->setUniformFloat("u_innerRadius", innerRadius / r4);
+    state->setUniformVec4("u_coreColor", Vec4(coreCol.r, coreCol.g, coreCol.b, coreCol.a));
+    state->setUniformVec4("u_surfColor", Vec4(surfCol.r, surfCol.g, surfCol.b, surfCol.a));
+    state->setUniformVec4("u_atmoColor", Vec4(atmoCol.r, atmoCol.g, atmoCol.b, atmoCol.a));
+    state->setUniformVec4("u_spacColor", Vec4(spacCol.r, spacCol.g, spacCol.b, spacCol.a));
+    state->setUniformVec4("u_crustColor", Vec4(crustCol.r, crustCol.g, crustCol.b, crustCol.a));
+
+    // Some big stuff inside for decoration and to see rotation
+    float k = _coreRadius / r4;
+    state->setUniformVec3("u_spot1", Vec3(0.6f * k, 0.0f, 0.3f * k));
+    state->setUniformVec3("u_spot2", Vec3(0.0f, 0.6f * k, 0.3f * k));
+    state->setUniformVec3("u_spot3", Vec3(-0.3f * k, -0.3f * k, 0.4f * k));
+    state->setUniformVec4("u_spot1Color", Vec4(1.0f, 1.0f, 0.0f, 1.0f));
+    state->setUniformVec4("u_spot2Color", Vec4(1.0f, 0.6f, 0.0f, 1.0f));
+    state->setUniformVec4("u_spot3Color", Vec4(0.8f, 1.0f, 0.0f, 1.0f));
+
+    for (size_t ci = 0; ci < _chunks.size(); ci++) {
+        drawChunk(ci);
     }
+}
+
+void Planet::drawChunk(size_t ci)
+{
+    Chunk& chunk = _chunks[ci];
+    chunk.node->clear();
+    chunk.bounds = Rect::ZERO;
 
     // Draw platforms
     for (Platform& platform : _platforms) {
-        node()->drawSolidPoly(platform.pts, Platform::POINTS, platformCol);
+        if (getChunkIndex(platform.pts[0].getAngle()) == ci) {
+            chunk.node->drawSolidPoly(platform.pts, Platform::POINTS, gPlatformColor);
+            chunk.add(platform.pts, Platform::POINTS);
+        }
     }
 
-    // Draw crust
-    Vec2 vert[3];
-    vert[2] = Vec2::ZERO;
-    Vec2 c1 = _crust.back();
-    for (Vec2& c2 : _crust) {
-        vert[0] = c1;
-        vert[1] = c2;
-        node()->drawSolidPoly(vert, 3, crustCol);
-        c1 = c2;
+    // Draw outer crust ring of active level, inner part is drawn by shader
+    float innerRadius = _coreRadius * gPlanetInnerCrust;
+    std::vector<Vec2> pts;
+    getChunkCrust(chunk, pts);
+    Vec2 vert[4];
+    for (size_t i = 1; i < pts.size(); i++) {
+        vert[0] = pts[i - 1].getNormalized() * innerRadius;
+        vert[1] = pts[i - 1];
+        vert[2] = pts[i];
+        vert[3] = pts[i].getNormalized() * innerRadius;
+        chunk.node->drawSolidPoly(vert, 4, gCrustColor);
+        chunk.add(vert, 4);
     }
 
-    auto pi1 = (_segments.end() - 1)->pts.end() - 1;
-    for (auto i2 = _segments.begin(), e2 = _segments.end(); i2 != e2; ++i2) {
-        Segment& seg2 = *i2;
-        for (auto pi2 = seg2.pts.begin(), pe2 = seg2.pts.end(); pi2 != pe2; ++pi2) {
-            float a1 = pi1->angle;
-            float a2 = pi2->angle;
-            std::vector<Stratum>* st1 = &pi1->strata;
-            std::vector<Stratum>* st2 = &pi2->strata;
-
-            // Merge sort
-            auto st1i = st1->begin();
-            auto st1e = st1->end();
-            auto st2i = st2->begin();
-            auto st2e = st2->end();
-            while (st2i != st2e && st1i != st1e) {
-                if (st1i->id == st2i->id) {
-                    Stratum s1 = *st1i;
-                    Stratum s2 = *st2i;
-                    drawStratumCell(a1, a2, s1, s2);
-                    ++st1i;
-                    ++st2i;
-                } else if (st1i->id < st2i->id) {
-                    ++st1i;
-                } else {
-                    ++st2i;
-                }
+    // Strata are drawn between coarse points, chunks with deposits are not refined there
+    for (size_t i = chunk.crust1; i < chunk.crust2; i++) {
+        const GeoPoint* pt1 = _geoPts[i];
+        const GeoPoint* pt2 = _geoPts[(i + 1) % _geoPts.size()];
+        float a1 = pt1->angle;
+        float a2 = pt2->angle;
+        const std::vector<Stratum>* st1 = &pt1->strata;
+        const std::vector<Stratum>* st2 = &pt2->strata;
+
+        // Merge sort
+        auto st1i = st1->begin();
+        auto st1e = st1->end();
+        auto st2i = st2->begin();
+        auto st2e = st2->end();
+        while (st2i != st2e && st1i != st1e) {
+            if (st1i->id == st2i->id) {
+                Stratum s1 = *st1i;
+                Stratum s2 = *st2i;
+                drawStratumCell(chunk, a1, a2, s1, s2);
+                ++st1i;
+                ++st2i;
+            } else if (st1i->id < st2i->id) {
+                ++st1i;
+            } else {
+                ++st2i;
             }
-            pi1 = pi2;
         }
     }
-
-    // Some big stuff inside for decoration and to see rotation
-    node()->drawSolidCircle(Vec2(_coreRadius*0.6, 0), _coreRadius*0.3, 0, 48, Color4F(1.0f, 1.0f, 0.0f, 1.0f));
-    node()->drawSolidCircle(Vec2(0, _coreRadius*0.6), _coreRadius*0.3, 0, 48, Color4F(1.0f, 0.6f, 0.0f, 1.0f));
-    node()->drawSolidCircle(Vec2(-_coreRadius*0.3, -_coreRadius*0.3), _coreRadius*0.4, 0, 48, Color4F(0.8f, 1.0f, 0.0f, 1.0f));
 }
 
-void Planet::drawStratumCell(float a1, float a2, const Stratum& s1, const Stratum& s2)
+void Planet::drawStratumCell(Chunk& chunk, float a1, float a2, const Stratum& s1, const Stratum& s2)
 {
     float r11 = _coreRadius + s1.alt1;
     float r12 = _coreRadius + s2.alt1;
@@ -299,34 +438,145 @@ void Planet::drawStratumCell(float a1, float a2, const Stratum& s1, const Stratu
     Vec2 v12(r12 * cosf(a2), r12 * sinf(a2));
     Vec2 v21(r21 * cosf(a1), r21 * sinf(a1));
     Vec2 v22(r22 * cosf(a2), r22 * sinf(a2));
-    node()->drawTriangleGradient(v11, v21, v12, s1.col1, s2.col1, s1.col2);
-    node()->drawTriangleGradient(v12, v21, v22, s1.col2, s2.col1, s2.col2);
+    chunk.node->drawTriangleGradient(v11, v21, v12, s1.col1, s2.col1, s1.col2);
+    chunk.node->drawTriangleGradient(v12, v21, v22, s1.col2, s2.col1, s2.col2);
+    Vec2 verts[] = { v11, v12, v21, v22 };
+    chunk.add(verts, 4);
+}
+
+size_t Planet::getChunkIndex(float a) const
+{
+    size_t size = _chunks.size();
+    return (size_t)(angleMain(a) / (2 * M_PI) * size) % size;
+}
+
+void Planet::getChunkCrust(const Chunk& chunk, std::vector<Vec2>& pts) const
+{
+    if (!chunk.detail.empty()) {
+        pts = chunk.detail;
+    } else if (chunk.crust1 < chunk.crust2) {
+        pts.assign(_crust.begin() + chunk.crust1, _crust.begin() + chunk.crust2);
+        pts.push_back(_crust[chunk.crust2 % _crust.size()]); // End of the last edge
+    } else {
+        pts.clear();
+    }
 }
 
+void Planet::buildChunkShapes(Chunk& chunk)
+{
+    for (PhysicsShape* shape : chunk.shapes) {
+        _body->removeShape(shape, false);
+    }
+    chunk.shapes.clear();
+
+    std::vector<Vec2> pts;
+    getChunkCrust(chunk, pts);
+    Vec2 vert[3];
+    vert[2] = Vec2::ZERO;
+    for (size_t i = 1; i < pts.size(); i++) {
+        vert[0] = pts[i - 1];
+        vert[1] = pts[i];
+        auto shape = PhysicsShapePolygon::create(vert, 3, gPlanetMaterial);
+        shape->setCategoryBitmask(_zs);
+        shape->setContactTestBitmask(_zs);
+        shape->setCollisionBitmask(_zs);
+        _body->addShape(shape, false);
+        chunk.shapes.push_back(shape);
+    }
+}
+
+size_t Planet::addDetail(size_t ci)
+{
+    Chunk& chunk = _chunks[ci];
+    if (!chunk.detail.empty() || chunk.crust1 == chunk.crust2) {
+        return 0;
+    }
+
+    size_t n = _crust.size();
+    for (size_t i = chunk.crust1; i < chunk.crust2; i++) {
+        const GeoPoint* pt1 = _geoPts[i];
+        const GeoPoint* pt2 = _geoPts[(i + 1) % n];
+        Vec2 c1 = _crust[i];
+        Vec2 c2 = _crust[(i + 1) % n];
+        chunk.detail.push_back(c1);
+        if (!pt1->strata.empty() || !pt2->strata.empty()) {
+            continue; // Deposits keep coarse edges, so that strata match surface
+        }
+        float length = c1.distance(c2);
+        size_t count = size_t(length / gTerrainDetailStep);
+        if (count < 2) {
+            continue;
+        }
+
+        // Relief is a few harmonics faded at ends of edge, so that neighbour edges and chunks match.
+        // Every edge has its own random stream, so relief does not depend on chunk bounds
+        Rng rng(_seed, i + 1);
+        constexpr size_t harmonics = 3;
+        float freq[harmonics];
+        float phase[harmonics];
+        for (size_t h = 0; h < harmonics; h++) {
+            freq[h] = (1 << h) * rng.uniform(1.0f, 2.0f);
+            phase[h] = rng.uniform(0.0f, 2 * M_PI);
+        }
+        float amplitude = std::min(gTerrainDetailAmplitude, length * 0.1f);
+        float a1 = pt1->angle;
+        float a2 = (pt2->angle < a1? pt2->angle + 2 * M_PI: pt2->angle);
+        for (size_t j = 1; j < count; j++) {
+            float t = float(j) / count;
+            float relief = 0.0f;
+            for (size_t h = 0; h < harmonics; h++) {
+                relief += sinf(2 * M_PI * freq[h] * t + phase[h]) / (1 << h);
+            }
+            relief *= amplitude * sinf(M_PI * t) / 1.75f; // Sum of harmonic weights
+            float alt = pt1->altitude + t * (pt2->altitude - pt1->altitude) + relief;
+            chunk.detail.push_back(altAng2local(alt, a1 + t * (a2 - a1)));
+        }
+    }
+    chunk.detail.push_back(_crust[chunk.crust2 % n]);
 
-void Planet::drawAtmoCell(float r1, float r2, float a1, float a2, Color4F r1col, Color4F r2col)
+    buildChunkShapes(chunk);
+    drawChunk(ci);
+    return chunk.detail.size();
+}
+
+void Planet::removeDetail(size_t ci)
 {
-    Vec2 v11(r1 * cosf(a1), r1 * sinf(a1));
-    Vec2 v12(r1 * cosf(a2), r1 * sinf(a2));
-    Vec2 v21(r2 * cosf(a1), r2 * sinf(a1));
-    Vec2 v22(r2 * cosf(a2), r2 * sinf(a2));
-    node()->drawTriangleGradient(v11, v21, v12, r1col, r2col, r1col);
-    node()->drawTriangleGradient(v12, v21, v22, r1col, r2col, r2col);
+    Chunk& chunk = _chunks[ci];
+    if (chunk.detail.empty()) {
+        return;
+    }
+    std::vector<Vec2>().swap(chunk.detail); // Release memory
+    buildChunkShapes(chunk);
+    drawChunk(ci);
 }
 
-void Planet::fillCrust()
+void Planet::Chunk::add(const Vec2* verts, size_t count)
 {
-    _crust.reserve(_segments.size());
-    for (auto i = _segments.begin(), e = _segments.end(); i != e; ++i) {
-        Segment& seg = *i;
-        for (auto pi = seg.pts.begin(), pe = seg.pts.end(); pi != pe; ++pi) {
-            float r = _coreRadius + pi->altitude;
-            float a = pi->angle;
-            _crust.push_back(r * Vec2::forAngle(a));
+    for (size_t i = 0; i < count; i++) {
+        if (bounds.equals(Rect::ZERO)) {
+            bounds.origin = verts[i];
+        } else {
+            bounds.merge(Rect(verts[i].x, verts[i].y, 0, 0));
         }
     }
 }
 
+void Planet::cull(const WorldView& view)
+{
+    Node* root = getNode();
+    Vec2 center = root->getPosition();
+    root->setVisible(view.isVisible(center, _coreRadius + _spacAltitude));
+    if (!root->isVisible()) {
+        return;
+    }
+    for (Chunk& chunk : _chunks) {
+        Vec2 mid(chunk.bounds.getMidX(), chunk.bounds.getMidY());
+        float radius = chunk.bounds.size.width / 2 + chunk.bounds.size.height / 2;
+        chunk.node->setVisible(view.isVisible(root->convertToWorldSpace(mid), radius));
+    }
+}
+
+
 Platform::Platform(Vec2 pt0, Vec2 pt1, Vec2 pt2, Vec2 pt3)
 {
     pts[0] = pt0;
@@ -133,11 +133,42 @@ struct Polar {
     }
 };
 
+// Parameters and generated terrain of planet. Terrain is generated from seed only, so that
+// descriptions may be generated concurrently off the main thread and then given to Planet::create()
+struct PlanetDesc {
+    ui64 seed = 0;
+    cc::Vec2 position;
+    float coreRadius = 6000;
+    float surfAltitude = 100;
+    float atmoAltitude = 1500;
+    float spacAltitude = 6000;
+    float mass = 1e10;
+    float moment = 1e12;
+    size_t mountainCount = 100;
+    float mountainHeight = 300;
+    size_t depositCount = 50;
+
+    // Result of generate(), segments and strata point to each other, so description is move-only
+    AngularVec<Segment> segments;
+    std::list<Deposit> deposits;
+    std::vector<cc::Vec2> crust;
+
+    PlanetDesc() : segments(360) {}
+    PlanetDesc(const PlanetDesc&) = delete;
+    PlanetDesc& operator=(const PlanetDesc&) = delete;
+    PlanetDesc(PlanetDesc&&) = default;
+    PlanetDesc& operator=(PlanetDesc&&) = default;
+
+    void generate();
+};
+
 class Planet : public AstroObj {
 public:
-    OBJ_CREATE_FUNC(Planet);
+    static Planet* create(GameScene* game, PlanetDesc&& desc);
     float getSize() override;
     const AngularVec<Segment>& segments() const { return _segments; }
+    const std::vector<Platform>& platforms() const { return _platforms; }
+    const std::vector<cc::Vec2>& crust() const { return _crust; } // Local points of surface
 
     // Get local/world position from polar/geogr
     cc::Vec2 polar2local(float r, float a);
@@ -153,26 +184,57 @@ public:
 
     // Get crust parameters
     float getAltitudeAt(float a) const;
+    float getCoreRadius() const { return _coreRadius; }
+    float getAtmosphereRadius() const { return _coreRadius + _atmoAltitude; }
+    float getSpaceRadius() const { return _coreRadius + _spacAltitude; }
 
     void addPlatform(Platform&& platform);
+    void cull(const WorldView& view) override;
+
+    // Crust of every chunk is either coarse (points of segments) or refined with generated relief.
+    // Collision shapes and geometry are built from active level of chunk. Gameplay queries
+    // (e.g. getAltitudeAt()) always use coarse profile, relief does not deviate from it much
+    size_t getChunkCount() const { return _chunks.size(); }
+    size_t getChunkIndex(float a) const; // Chunk at local angle a
+    bool hasDetail(size_t ci) const { return !_chunks[ci].detail.empty(); }
+    size_t addDetail(size_t ci); // Returns number of generated points
+    void removeDetail(size_t ci);
+protected:
+    // Crust, strata and platforms are split into angular chunks that are culled independently
+    struct Chunk {
+        cc::DrawNode* node = nullptr;
+        cc::Rect bounds; // Local bounding box of chunk geometry
+        size_t crust1 = 0; // Chunk has crust edges starting at points [crust1; crust2)
+        size_t crust2 = 0;
+        std::vector<cc::Vec2> detail; // Refined crust from point crust1 to point crust2, empty if coarse
+        std::vector<cc::PhysicsShape*> shapes; // Crust shapes of active level
+        void add(const cc::Vec2* verts, size_t count);
+    };
 protected:
     Planet();
-    virtual bool init(GameScene* game) override;
+    bool init(GameScene* game, PlanetDesc&& desc);
     cc::Node* createNodes() override;
     cc::PhysicsBody* createBody() override;
     void draw() override;
-    void drawAtmoCell(float r1, float r2, float a1, float a2, cc::Color4F r1col, cc::Color4F r2col);
-    void drawStratumCell(float a1, float a2, const Stratum& s1, const Stratum& s2);
-    void fillCrust();
+    void drawChunk(size_t ci);
+    void drawStratumCell(Chunk& chunk, float a1, float a2, const Stratum& s1, const Stratum& s2);
+    void getChunkCrust(const Chunk& chunk, std::vector<cc::Vec2>& pts) const;
+    void buildChunkShapes(Chunk& chunk);
 protected:
     cc::DrawNode* node() { return static_cast<cc::DrawNode*>(_rootNode); }
+    cc::Sprite* _atmoNode = nullptr; // Quad with atmosphere and inner core drawn by shader
     cc::PhysicsBody* _body = nullptr;
     float _coreRadius;
     float _surfAltitude;
     float _atmoAltitude;
     float _spacAltitude;
+    float _mass;
+    float _moment;
+    ui64 _seed;
     AngularVec<Segment> _segments;
     std::list<Deposit> _deposits;
     std::vector<cc::Vec2> _crust;
+    std::vector<const GeoPoint*> _geoPts; // Points of segments in order of crust points
     std::vector<Platform> _platforms;
+    std::vector<Chunk> _chunks;
 };
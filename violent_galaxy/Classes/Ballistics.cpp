@@ -0,0 +1,186 @@
+#include "Ballistics.h"
+#include "GameScene.h"
+#include "Projectiles.h"
+
+USING_NS_CC;
+
+void Ballistics::init(GameScene* game)
+{
+    _game = game;
+    _node = DrawNode::create();
+    _node->setCameraMask((unsigned short)gWorldCameraFlag);
+    _game->addChild(_node, ZsOrder(ZsProjectileDefault));
+}
+
+void Ballistics::launch(Vec2 p, Vec2 v, Color4F color, i32 damage, Id ownerId)
+{
+    _x.push_back(p.x);
+    _y.push_back(p.y);
+    _vx.push_back(v.x);
+    _vy.push_back(v.y);
+    _ttl.push_back(gBallisticsLifetime);
+    _damage.push_back(damage);
+    _owner.push_back(ownerId);
+    _color.push_back(color);
+}
+
+void Ballistics::update(float delta)
+{
+    if (!_x.empty()) {
+        const std::vector<Planet*>& planets = _game->planets();
+
+        // Substeps are short enough for accurate integration and for sweeps to fit unit grid cells
+        float maxSpeedSq = 0.0f;
+        for (size_t i = 0; i < _x.size(); i++) {
+            maxSpeedSq = std::max(maxSpeedSq, _vx[i] * _vx[i] + _vy[i] * _vy[i]);
+        }
+        int substeps = (int)std::max(ceilf(delta / gBallisticsStep), ceilf(sqrtf(maxSpeedSq) * delta / gBallisticsMaxSweep));
+        float dt = delta / std::max(1, substeps);
+        for (int k = 0; k < substeps && !_x.empty(); k++) {
+            step(dt, planets);
+        }
+
+        // Units are hit after all shells are moved, so that grid has no destroyed ones during sweeps.
+        // Shells launched by hit units (e.g. explosion fragments) fly since next update
+        std::vector<Hit> hits;
+        std::swap(hits, _hits);
+        for (const Hit& hit : hits) {
+            if (Unit* unit = _game->objs()->getByIdAs<Unit>(hit.unitId)) {
+                Projectile::hitUnit(unit, hit.p, hit.v, Shell::bodyMass, hit.damage);
+            }
+        }
+    }
+    draw();
+}
+
+void Ballistics::step(float dt, const std::vector<Planet*>& planets)
+{
+    size_t count = _x.size();
+    _gx.resize(count);
+    _gy.resize(count);
+    _game->physicsWorld()->getForceField()->getGravity(count, _x.data(), _y.data(), _gx.data(), _gy.data());
+
+    // Semi-implicit Euler, the same as chipmunk does for bodies
+    for (size_t i = 0; i < count; i++) {
+        _vx[i] += _gx[i] * dt;
+        _vy[i] += _gy[i] * dt;
+        _ttl[i] -= dt;
+    }
+
+    for (size_t i = 0; i < _x.size(); ) {
+        Vec2 p1(_x[i], _y[i]);
+        Vec2 v(_vx[i], _vy[i]);
+        Vec2 p2 = p1 + v * dt;
+        Id unitId = 0;
+        float unitFraction = sweepUnits(p1, p2, _owner[i], unitId);
+        float crustFraction = sweepCrust(p1, p2, planets);
+        if (unitFraction < 1.0f && unitFraction <= crustFraction) {
+            _hits.push_back(Hit{unitId, p1.lerp(p2, unitFraction), v, _damage[i]});
+            blast(p1.lerp(p2, unitFraction));
+            remove(i);
+        } else if (crustFraction < 1.0f) {
+            blast(p1.lerp(p2, crustFraction));
+            remove(i);
+        } else if (_ttl[i] <= 0.0f) {
+            remove(i);
+        } else {
+            _x[i] = p2.x;
+            _y[i] = p2.y;
+            i++;
+        }
+    }
+}
+
+float Ballistics::sweepUnits(Vec2 p1, Vec2 p2, Id ownerId, Id& unitId)
+{
+    // Units are circles of the same radius as used for separation, shell is swept circle
+    Vec2 d = p2 - p1;
+    float dlenSq = d.lengthSquared();
+    float fraction = 1.0f;
+    _game->unitGrid().query(p1.lerp(p2, 0.5f), sqrtf(dlenSq) / 2 + gBallisticsShellSize,
+                            [&] (Unit* unit, Vec2 c, float radius, float distSq) -> bool {
+        if (unit->getId() == ownerId || unit->hp <= 0) {
+            return true; // Dying units are still in grid
+        }
+        float r = radius + gBallisticsShellSize;
+        Vec2 f = p1 - c;
+        float c0 = f.lengthSquared() - r * r;
+        if (c0 <= 0.0f) {
+            fraction = 0.0f; // Starts inside
+            unitId = unit->getId();
+            return false;
+        }
+        if (dlenSq == 0.0f) {
+            return true;
+        }
+        // Smallest root of |f + t*d|^2 = r^2
+        float b = f.dot(d);
+        float disc = b * b - dlenSq * c0;
+        if (b < 0.0f && disc >= 0.0f) {
+            float t = (-b - sqrtf(disc)) / dlenSq;
+            if (t < fraction) {
+                fraction = t;
+                unitId = unit->getId();
+            }
+        }
+        return true;
+    });
+    return fraction;
+}
+
+float Ballistics::sweepCrust(Vec2 p1, Vec2 p2, const std::vector<Planet*>& planets)
+{
+    float length = p1.distance(p2);
+    int samples = std::max(1, (int)ceilf(length / gBallisticsCrustStep));
+    for (Planet* planet : planets) {
+        Vec2 center = planet->getNode()->getPosition();
+        if (p1.distance(center) > planet->getSize() + length) {
+            continue; // Far away from crust
+        }
+        for (int k = 1; k <= samples; k++) {
+            float t = float(k) / samples;
+            Polar polar = planet->world2polar(p1.lerp(p2, t));
+            if (polar.r < planet->getCoreRadius() + planet->getAltitudeAt(polar.a)) {
+                return t;
+            }
+        }
+    }
+    return 1.0f;
+}
+
+void Ballistics::blast(Vec2 p)
+{
+    if (gShellBlastRadius > 0.0f) {
+        _game->blasts()->add(p, gShellBlastRadius, gShellBlastDamage, gShellBlastImpulse);
+    }
+}
+
+void Ballistics::remove(size_t i)
+{
+    // Order of shells does not matter, so fill the hole with the last one
+    size_t last = _x.size() - 1;
+    _x[i] = _x[last];
+    _y[i] = _y[last];
+    _vx[i] = _vx[last];
+    _vy[i] = _vy[last];
+    _ttl[i] = _ttl[last];
+    _damage[i] = _damage[last];
+    _owner[i] = _owner[last];
+    _color[i] = _color[last];
+    _x.pop_back();
+    _y.pop_back();
+    _vx.pop_back();
+    _vy.pop_back();
+    _ttl.pop_back();
+    _damage.pop_back();
+    _owner.pop_back();
+    _color.pop_back();
+}
+
+void Ballistics::draw()
+{
+    _node->clear();
+    for (size_t i = 0; i < _x.size(); i++) {
+        _node->drawDot(Vec2(_x[i], _y[i]), gBallisticsShellSize, _color[i]);
+    }
+}
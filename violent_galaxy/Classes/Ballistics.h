@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Defs.h"
+#include <chipmunk/chipmunk_types.h>
+
+#include <vector>
+
+class GameScene;
+class Planet;
+
+// Shells that are not physics bodies. All shells in flight are kept in flat arrays and
+// integrated in bulk under the force field. Hits are resolved by sweeping the segment passed
+// by shell during substep against units and planet crust, so fast shells never tunnel.
+// All shells are drawn by single draw node
+class Ballistics {
+public:
+    void init(GameScene* game);
+    void update(float delta);
+
+    // Launches shell from world point p with velocity v, it never hits unit with ownerId
+    void launch(cc::Vec2 p, cc::Vec2 v, cc::Color4F color, i32 damage, Id ownerId);
+
+    size_t size() const { return _x.size(); }
+private:
+    struct Hit {
+        Id unitId;
+        cc::Vec2 p;
+        cc::Vec2 v;
+        i32 damage;
+    };
+
+    void step(float dt, const std::vector<Planet*>& planets);
+    float sweepUnits(cc::Vec2 p1, cc::Vec2 p2, Id ownerId, Id& unitId); // Returns fraction of segment before hit or 1
+    float sweepCrust(cc::Vec2 p1, cc::Vec2 p2, const std::vector<Planet*>& planets);
+    void blast(cc::Vec2 p);
+    void remove(size_t i);
+    void draw();
+private:
+    GameScene* _game = nullptr;
+    cc::DrawNode* _node = nullptr;
+
+    // Shell parameters, i-th element of every array belongs to i-th shell
+    std::vector<cpFloat> _x;
+    std::vector<cpFloat> _y;
+    std::vector<cpFloat> _vx;
+    std::vector<cpFloat> _vy;
+    std::vector<cpFloat> _gx;
+    std::vector<cpFloat> _gy;
+    std::vector<float> _ttl;
+    std::vector<i32> _damage;
+    std::vector<Id> _owner;
+    std::vector<cc::Color4F> _color;
+
+    std::vector<Hit> _hits; // Resolved after all shells are moved, because hit may destroy unit
+};
@@ -0,0 +1,77 @@
+#include "Blasts.h"
+#include "GameScene.h"
+
+USING_NS_CC;
+
+void Blasts::init(GameScene* game)
+{
+    _game = game;
+}
+
+void Blasts::add(Vec2 p, float radius, i32 damage, float impulse)
+{
+    _queue.push_back(Blast{p, radius, damage, impulse});
+}
+
+void Blasts::update(float delta)
+{
+    size_t count = std::min(_queue.size(), gBlastsPerUpdate);
+    if (count == 0) {
+        return;
+    }
+
+    // Find units near all blasts at once
+    _points.clear();
+    _radii.clear();
+    _masks.clear();
+    for (size_t k = 0; k < count; k++) {
+        _points.push_back(_queue[k].p);
+        _radii.push_back(_queue[k].radius);
+        _masks.push_back(ZsBackground | ZsForeground); // Units are on one of these
+    }
+    _game->physicsWorld()->queryPoints(count, _points.data(), _radii.data(), _masks.data(), _offsets, _shapes);
+
+    // Sum effects of all blasts per unit, unit may have several shapes but is affected once by every blast
+    _effects.clear();
+    _effectIdx.clear();
+    for (size_t k = 0; k < count; k++) {
+        const Blast& blast = _queue[k];
+        for (int s = _offsets[k]; s < _offsets[k + 1]; s++) {
+            Node* node = _shapes[s]->getBody()->getNode();
+            ObjTag tag(node->getTag());
+            if (tag.type() != ObjType::Unit) {
+                continue;
+            }
+            auto inserted = _effectIdx.emplace(tag.id(), _effects.size());
+            if (inserted.second) {
+                _effects.push_back(Effect{tag.id(), Vec2::ZERO, 0.0f, count});
+            }
+            Effect& effect = _effects[inserted.first->second];
+            if (effect.blast == k) {
+                continue;
+            }
+            effect.blast = k;
+            Vec2 d = node->getPhysicsBody()->getPosition() - blast.p;
+            float falloff = std::max(0.0f, 1.0f - d.length() / blast.radius);
+            effect.damage += blast.damage * falloff;
+            effect.j += d.getNormalized() * (blast.impulse * falloff);
+        }
+    }
+    _queue.erase(_queue.begin(), _queue.begin() + count);
+
+    // Units destroyed here blast too, their blasts are queued and resolved by next updates
+    for (const Effect& effect : _effects) {
+        Unit* unit = _game->objs()->getByIdAs<Unit>(effect.unitId);
+        if (!unit || unit->hp <= 0) {
+            continue; // Already dying
+        }
+        auto body = unit->getNode()->getPhysicsBody();
+        body->applyImpulse(body->world2Local(effect.j) - body->world2Local(Vec2::ZERO));
+        unit->railsLeaveRequested = true; // Impulse is ignored on rails, but next one will not be
+        unit->wake();
+        i32 damage = (i32)lroundf(effect.damage);
+        if (damage > 0) {
+            unit->damage(damage);
+        }
+    }
+}
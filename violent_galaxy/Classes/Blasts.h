@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Defs.h"
+
+#include <unordered_map>
+#include <vector>
+
+class GameScene;
+class Unit;
+
+// Area damage. Blasts are queued and resolved together: all units in blast radii are found by
+// one batch physics query, damage and impulses of all blasts are summed per unit and applied once.
+// Units killed by blasts may blast too, so number of blasts resolved per update is limited and
+// chain explosions are spread over several frames
+class Blasts {
+public:
+    void init(GameScene* game);
+    void update(float delta);
+
+    // Queues blast at world point p, damage and impulse fall off linearly to zero at radius
+    void add(cc::Vec2 p, float radius, i32 damage, float impulse);
+
+    size_t size() const { return _queue.size(); }
+private:
+    struct Blast {
+        cc::Vec2 p;
+        float radius;
+        i32 damage;
+        float impulse;
+    };
+
+    struct Effect {
+        Id unitId;
+        cc::Vec2 j; // World impulse
+        float damage;
+        size_t blast; // Last blast that affected unit, to count every unit once per blast
+    };
+private:
+    GameScene* _game = nullptr;
+    std::vector<Blast> _queue;
+
+    // Buffers reused by every update
+    std::vector<cc::Vec2> _points;
+    std::vector<float> _radii;
+    std::vector<int> _masks;
+    std::vector<int> _offsets;
+    std::vector<cc::PhysicsShape*> _shapes;
+    std::vector<Effect> _effects;
+    std::unordered_map<Id, size_t> _effectIdx;
+};
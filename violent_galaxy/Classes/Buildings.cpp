@@ -5,21 +5,25 @@
 
 USING_NS_CC;
 
-void CaptureChecker::update(float delta, Player* player, VisualObj* obj, GameScene* game)
+void CaptureChecker::update(float delta, VisualObj* obj, GameScene* game, PhysicsShape* const* shapes, size_t count)
 {
-    std::set<Id> ids;
     Vec2 pw = obj->getNode()->getPosition();
-    game->physicsWorld()->queryPoint(
-        CC_CALLBACK_3(CaptureChecker::onQueryPoint, this, pw, obj->getSize(),
-                      -game->physicsWorld()->getForceField()->getGravity(pw).getNormalized()),
-        pw,
-        &ids,
-        obj->getSize() * 20
-    );
+    Vec2 up = -game->physicsWorld()->getForceField()->getGravity(pw).getNormalized();
+    Vec2 right = Vec2(up.y, -up.x); // rotate 90 degrees clockwise
+    float distance = obj->getSize();
     std::set<Player*> players;
-    for (Id id : ids) {
-        if (Unit* unit = game->objs()->getByIdAs<Unit>(id)) {
-            players.insert(unit->getPlayer());
+    for (size_t i = 0; i < count; i++) {
+        auto node = shapes[i]->getBody()->getNode();
+        ObjTag tag(node->getTag());
+        if (tag.type() != ObjType::Unit) {
+            continue;
+        }
+        Vec2 pos = node->getPhysicsBody()->getPosition();
+        float range = fabs(Vec2::dot(pos - pw, right));
+        if (range < distance) { // We take only horizontal coordinate into account to avoid problems with "flying" buildings
+            if (Unit* unit = game->objs()->getByIdAs<Unit>(tag.id())) {
+                players.insert(unit->getPlayer());
+            }
         }
     }
     if (players.size() == 1) {
@@ -43,25 +47,6 @@ void CaptureChecker::update(float delta, Player* player, VisualObj* obj, GameSce
     _capturer = nullptr;
 }
 
-bool CaptureChecker::onQueryPoint(PhysicsWorld& pworld, PhysicsShape& shape, void* userdata, Vec2 pw, float distance, Vec2 up)
-{
-    UNUSED(pworld);
-    auto node = shape.getBody()->getNode();
-    Vec2 pos = node->getPhysicsBody()->getPosition();
-
-    Vec2 right = Vec2(up.y, -up.x); // rotate 90 degrees clockwise
-    float range = fabs(Vec2::dot(pos - pw, right));
-    if (range < distance) { // We take only horizontal coordinate into account to avoid problems with "flying" buildings
-        std::set<Id>& ids = *reinterpret_cast<std::set<Id>*>(userdata);
-        ObjTag tag(node->getTag());
-        Id id = tag.id();
-        if (tag.type() == ObjType::Unit) {
-            ids.insert(id);
-        }
-    }
-    return true;
-}
-
 bool Building::init(GameScene* game)
 {
     VisualObj::init(game);
@@ -76,9 +61,9 @@ void Building::destroy()
     VisualObj::destroy();
 }
 
-void Building::update(float delta)
+void Building::captureUpdate(float delta, PhysicsShape* const* shapes, size_t count)
 {
-    _captureChecker.update(delta, _player, this, _game);
+    _captureChecker.update(delta, this, _game, shapes, count);
 }
 
 void Building::setPlayer(Player* player)
@@ -167,43 +152,45 @@ void Factory::draw()
     node()->clear();
     float r = _size / 2;
 
-    Color4F darkGray(colorFilter(Color4F(0.3f, 0.3f, 0.3f, 1.0f)));
-    node()->drawSolidRect(
-        Vec2(-0.7*r, 1.0*r),
-        Vec2(-0.3*r, 1.8*r),
-        darkGray
-    );
-    node()->drawSolidRect(
-        Vec2(0.3*r, 1.0*r),
-        Vec2(0.7*r, 1.8*r),
-        darkGray
-    );
-    node()->drawSolidRect(
-        Vec2(-r, -r),
-        Vec2( r, r),
-        colorFilter(Color4F::GRAY)
-    );
-    node()->drawSolidCircle(Vec2(0.6*r, 0.6*r), 0.1*r, 0, 12, darkGray);
-    node()->drawSolidRect(
-        Vec2(-0.9*r, -1.0*r),
-        Vec2(-0.7*r, 0.1*r),
-        colorFilter(Color4F::GRAY, 0.8f)
-    );
-    node()->drawSolidRect(
-        Vec2(0.7*r, -1.0*r),
-        Vec2(0.9*r, 0.1*r),
-        colorFilter(Color4F::GRAY, 0.8f)
-    );
-    node()->drawSolidRect(
-        Vec2(-0.6*r, -1.0*r),
-        Vec2(-0.5*r, -0.5*r),
-        colorFilter(Color4F::GRAY, 0.6f)
-    );
-    node()->drawSolidRect(
-        Vec2(0.5*r, -1.0*r),
-        Vec2(0.6*r, -0.5*r),
-        colorFilter(Color4F::GRAY, 0.6f)
-    );
+    drawCached(node(), 0, atlasKey(), Rect(-r, -r, 2*r, 2.8*r), [=] (DrawNode* node) {
+        Color4F darkGray(colorFilter(Color4F(0.3f, 0.3f, 0.3f, 1.0f)));
+        node->drawSolidRect(
+            Vec2(-0.7*r, 1.0*r),
+            Vec2(-0.3*r, 1.8*r),
+            darkGray
+        );
+        node->drawSolidRect(
+            Vec2(0.3*r, 1.0*r),
+            Vec2(0.7*r, 1.8*r),
+            darkGray
+        );
+        node->drawSolidRect(
+            Vec2(-r, -r),
+            Vec2( r, r),
+            colorFilter(Color4F::GRAY)
+        );
+        node->drawSolidCircle(Vec2(0.6*r, 0.6*r), 0.1*r, 0, 12, darkGray);
+        node->drawSolidRect(
+            Vec2(-0.9*r, -1.0*r),
+            Vec2(-0.7*r, 0.1*r),
+            colorFilter(Color4F::GRAY, 0.8f)
+        );
+        node->drawSolidRect(
+            Vec2(0.7*r, -1.0*r),
+            Vec2(0.9*r, 0.1*r),
+            colorFilter(Color4F::GRAY, 0.8f)
+        );
+        node->drawSolidRect(
+            Vec2(-0.6*r, -1.0*r),
+            Vec2(-0.5*r, -0.5*r),
+            colorFilter(Color4F::GRAY, 0.6f)
+        );
+        node->drawSolidRect(
+            Vec2(0.5*r, -1.0*r),
+            Vec2(0.6*r, -0.5*r),
+            colorFilter(Color4F::GRAY, 0.6f)
+        );
+    });
 }
 
 void Factory::update(float delta)
@@ -276,40 +263,42 @@ void Mine::draw()
     node()->clear();
     float r = _size / 2;
 
-    Color4F darkColor(colorFilter(Color4F(0.5f, 0.3f, 0.2f, 1.0f)));
-    Color4F mainColor(colorFilter(Color4F(0.6f, 0.4f, 0.3f, 1.0f)));
-    node()->drawSolidRect(
-        Vec2(-0.3*r, 1.0*r),
-        Vec2(0.3*r, 2.4*r),
-        darkColor
-    );
-    node()->drawSolidRect(
-        Vec2(-r, -r),
-        Vec2( r, r),
-        mainColor
-    );
-    node()->drawSolidCircle(Vec2(-0.4*r, 0.6*r), 0.1*r, 0, 12, 4.0, 1.0, darkColor);
-    node()->drawSolidCircle(Vec2(0.1*r, 0.45*r), 0.1*r, 0, 12, 2.0, 0.7, darkColor);
-    node()->drawSolidRect(
-        Vec2(-0.9*r, -1.0*r),
-        Vec2(-0.7*r, 0.1*r),
-        colorFilter(Color4F::GRAY, 0.8f)
-    );
-    node()->drawSolidRect(
-        Vec2(0.7*r, -1.0*r),
-        Vec2(0.9*r, 0.1*r),
-        colorFilter(Color4F::GRAY, 0.8f)
-    );
-    node()->drawSolidRect(
-        Vec2(-0.6*r, -1.0*r),
-        Vec2(-0.5*r, -0.5*r),
-        colorFilter(Color4F::GRAY, 0.6f)
-    );
-    node()->drawSolidRect(
-        Vec2(0.5*r, -1.0*r),
-        Vec2(0.6*r, -0.5*r),
-        colorFilter(Color4F::GRAY, 0.6f)
-    );
+    drawCached(node(), 0, atlasKey(), Rect(-r, -r, 2*r, 3.4*r), [=] (DrawNode* node) {
+        Color4F darkColor(colorFilter(Color4F(0.5f, 0.3f, 0.2f, 1.0f)));
+        Color4F mainColor(colorFilter(Color4F(0.6f, 0.4f, 0.3f, 1.0f)));
+        node->drawSolidRect(
+            Vec2(-0.3*r, 1.0*r),
+            Vec2(0.3*r, 2.4*r),
+            darkColor
+        );
+        node->drawSolidRect(
+            Vec2(-r, -r),
+            Vec2( r, r),
+            mainColor
+        );
+        node->drawSolidCircle(Vec2(-0.4*r, 0.6*r), 0.1*r, 0, 12, 4.0, 1.0, darkColor);
+        node->drawSolidCircle(Vec2(0.1*r, 0.45*r), 0.1*r, 0, 12, 2.0, 0.7, darkColor);
+        node->drawSolidRect(
+            Vec2(-0.9*r, -1.0*r),
+            Vec2(-0.7*r, 0.1*r),
+            colorFilter(Color4F::GRAY, 0.8f)
+        );
+        node->drawSolidRect(
+            Vec2(0.7*r, -1.0*r),
+            Vec2(0.9*r, 0.1*r),
+            colorFilter(Color4F::GRAY, 0.8f)
+        );
+        node->drawSolidRect(
+            Vec2(-0.6*r, -1.0*r),
+            Vec2(-0.5*r, -0.5*r),
+            colorFilter(Color4F::GRAY, 0.6f)
+        );
+        node->drawSolidRect(
+            Vec2(0.5*r, -1.0*r),
+            Vec2(0.6*r, -0.5*r),
+            colorFilter(Color4F::GRAY, 0.6f)
+        );
+    });
 }
 
 void Mine::update(float delta)
@@ -351,47 +340,49 @@ void PumpJack::draw()
     node()->clear();
     float r = _size / 2;
 
-    // Building under tower
-    node()->drawSolidRect(
-        r*Vec2(-0.5, -0.7), r*Vec2(1.0, -1.0),
-        colorFilter(Color4F::WHITE)
-    );
-
-    // Mine
-    node()->drawSolidRect(
-        r*Vec2(-0.979, -0.95), r*Vec2(-0.579, -1.0),
-        colorFilter(Color4F::WHITE)
-    );
-
-    Vec2 tower[] = {
-        r*Vec2(0.0, 0.6), r*Vec2(0.0, 0.4), r*Vec2(-0.4, -0.7),
-        r*Vec2(0.6, -0.7), r*Vec2(0.2, 0.4), r*Vec2(0.2, 0.6)
-    };
-    node()->drawSolidPoly(tower, sizeof(tower)/sizeof(*tower), colorFilter(Color4F::GRAY));
-
-    Vec2 hammer[] = {
-        r*Vec2(0.884, 0.313), r*Vec2(-0.614, 0.875),
-        r*Vec2(-0.684, 0.687), r*Vec2(0.814, 0.125)
-    };
-    node()->drawSolidPoly(hammer, sizeof(hammer)/sizeof(*hammer), colorFilter(Color4F::WHITE, 0.8));
-
-    Vec2 hammerHead[] = {
-        r*Vec2(-0.520, 0.839), r*Vec2(-0.508, 1.155), r*Vec2(-0.708, 0.910),
-        r*Vec2(-0.778, 0.722), r*Vec2(-0.789, 0.406), r*Vec2(-0.590, 0.652)
-    };
-    node()->drawSolidPoly(hammerHead, sizeof(hammerHead)/sizeof(*hammerHead), colorFilter(Color4F(1.0, 0.4, 0.2, 1.0)));
-
-    // Thread from hammer head to mine
-    node()->drawSolidRect(
-        r*Vec2(-0.789, 0.406), r*Vec2(-0.770, -0.950),
-        colorFilter(Color4F::BLACK)
-    );
-
-    node()->drawSolidRect(
-        Vec2(0.0*r,  0.0*r),
-        Vec2(0.2*r, -0.7*r),
-        colorFilter(Color4F::GRAY, 0.8f)
-    );
+    drawCached(node(), 0, atlasKey(), Rect(-r, -r, 2*r, 2.2*r), [=] (DrawNode* node) {
+        // Building under tower
+        node->drawSolidRect(
+            r*Vec2(-0.5, -0.7), r*Vec2(1.0, -1.0),
+            colorFilter(Color4F::WHITE)
+        );
+
+        // Mine
+        node->drawSolidRect(
+            r*Vec2(-0.979, -0.95), r*Vec2(-0.579, -1.0),
+            colorFilter(Color4F::WHITE)
+        );
+
+        Vec2 tower[] = {
+            r*Vec2(0.0, 0.6), r*Vec2(0.0, 0.4), r*Vec2(-0.4, -0.7),
+            r*Vec2(0.6, -0.7), r*Vec2(0.2, 0.4), r*Vec2(0.2, 0.6)
+        };
+        node->drawSolidPoly(tower, sizeof(tower)/sizeof(*tower), colorFilter(Color4F::GRAY));
+
+        Vec2 hammer[] = {
+            r*Vec2(0.884, 0.313), r*Vec2(-0.614, 0.875),
+            r*Vec2(-0.684, 0.687), r*Vec2(0.814, 0.125)
+        };
+        node->drawSolidPoly(hammer, sizeof(hammer)/sizeof(*hammer), colorFilter(Color4F::WHITE, 0.8));
+
+        Vec2 hammerHead[] = {
+            r*Vec2(-0.520, 0.839), r*Vec2(-0.508, 1.155), r*Vec2(-0.708, 0.910),
+            r*Vec2(-0.778, 0.722), r*Vec2(-0.789, 0.406), r*Vec2(-0.590, 0.652)
+        };
+        node->drawSolidPoly(hammerHead, sizeof(hammerHead)/sizeof(*hammerHead), colorFilter(Color4F(1.0, 0.4, 0.2, 1.0)));
+
+        // Thread from hammer head to mine
+        node->drawSolidRect(
+            r*Vec2(-0.789, 0.406), r*Vec2(-0.770, -0.950),
+            colorFilter(Color4F::BLACK)
+        );
+
+        node->drawSolidRect(
+            Vec2(0.0*r,  0.0*r),
+            Vec2(0.2*r, -0.7*r),
+            colorFilter(Color4F::GRAY, 0.8f)
+        );
+    });
 }
 
 void PumpJack::update(float delta)
@@ -11,9 +11,9 @@ private:
     float _elapsed = 0.0f;
     Player* _capturer = nullptr;
 public:
-    void update(float delta, Player* player, VisualObj* obj, GameScene* game);
-    bool onQueryPoint(cc::PhysicsWorld& pworld, cc::PhysicsShape& shape,
-                      void* userdata, cc::Vec2 pw, float distance, cc::Vec2 up);
+    // Shapes near obj are found by one batch query for all buildings, see GameScene::captureUpdate()
+    void update(float delta, VisualObj* obj, GameScene* game, cc::PhysicsShape* const* shapes, size_t count);
+    static float queryDistance(VisualObj* obj) { return obj->getSize() * 20; }
 };
 
 class Building : public VisualObj {
@@ -21,7 +21,9 @@ public:
     Id surfaceId = 0; // Astro obj that builing is placed on
     ObjType getObjType() override;
     void destroy() override;
-    void update(float delta) override;
+    void captureUpdate(float delta, cc::PhysicsShape* const* shapes, size_t count);
+    float getSightRadius() override { return gBuildingSightRadius; }
+    bool isFoggable() override { return true; }
     virtual float getProductionProgress() { return 0.0f; }
     void setPlayer(Player *player) override;
 private:
@@ -39,6 +39,8 @@ const cc::Color4F gHpBgColor    (0.7f, 0.7f, 0.7f, 1.0f);
 const cc::Color4F gProdColor      (0.0f, 1.0f, 1.0f, 1.0f);
 const cc::Color4F gProdBgColor    (0.7f, 0.7f, 0.7f, 1.0f);
 const cc::Color4F gIndicatorBorderColor(0.0f, 0.0f, 0.0f, 1.0f);
+const cc::Color4F gCrustColor(0.5f, 0.4f, 0.0f, 1.0f);
+const cc::Color4F gPlatformColor(0.4f, 0.4f, 0.4f, 1.0f);
 
 // GUI
 const cc::Color4F gPanelBgColor    (0.0f, 0.0f, 0.0f, 1.0f);
@@ -49,6 +51,9 @@ float gMiniMapPanelWidth = 250;
 float gMiniMapPanelHeight = 250;
 float gControlPanelWidth = 350;
 float gControlPanelHeight = 250;
+float gMiniMapUpdateInterval = 0.2f;
+float gMiniMapMarkerSize = 3.0f;
+float gMiniMapRange = 2.0f;
 
 // Z-Order
 const int gZOrderMouseSelectionRect = 1000;
@@ -56,6 +61,7 @@ const int gZOrderIndicators = 2000;
 const int gZOrderResIcons = 2001;
 const int gZOrderResLabels = 2002;
 const int gZOrderSelectionPanel = 3000;
+const int gZOrderMiniMap = 3001;
 
 // Keyboard
 cc::EventKeyboard::KeyCode gHKGroup[10] = {
@@ -81,7 +87,111 @@ cc::EventKeyboard::KeyCode gHKPowerInc = cc::EventKeyboard::KeyCode::KEY_R;
 cc::EventKeyboard::KeyCode gHKPowerDec = cc::EventKeyboard::KeyCode::KEY_F;
 cc::EventKeyboard::KeyCode gHKShoot = cc::EventKeyboard::KeyCode::KEY_SPACE;
 cc::EventKeyboard::KeyCode gHKHold = cc::EventKeyboard::KeyCode::KEY_H;
+cc::EventKeyboard::KeyCode gHKTimeWarpFaster = cc::EventKeyboard::KeyCode::KEY_EQUAL;
+cc::EventKeyboard::KeyCode gHKTimeWarpSlower = cc::EventKeyboard::KeyCode::KEY_MINUS;
 
 // Orders
 size_t gMaxOrders = 32;
 float gOrderDelayTimeout = 10;
+float gFormationSpacing = 40.0f;
+
+// Pathing
+float gFlowFieldMaxSlope = 0.7f;
+float gFlowFieldSlopeCost = 4.0f;
+float gFlowFieldPlatformCost = 50.0f;
+float gFlowFieldDensityCost = 20.0f;
+float gFlowFieldTtl = 1.0f;
+
+// Simulation clock
+int gSimulationRate = 120;
+int gSimulationMaxSteps = 8;
+bool gSimulationInterpolation = true;
+bool gSimulationThread = true;
+
+// Time warp
+float gTimeWarpLevels[WARP_COUNT] = { 1.0f, 2.0f, 4.0f, 16.0f };
+float gTimeWarpMaxSpeed = 256.0f;
+float gTimeWarpMinFps = 15.0f;
+float gTimeWarpRenderFps = 20.0f;
+
+// Sleeping
+float gSleepTimeThreshold = 0.5f;
+float gIdleSpeedThreshold = 2.0f;
+float gIdleAngularVelocity = 0.01f;
+
+// Simulation LOD
+float gLodUpdateInterval = 0.5f;
+float gLodViewMargin = 1000.0f;
+float gLodEnemyDistance = 3000.0f;
+float gLodMaxRadialVelocity = 5.0f;
+
+// Planet
+float gPlanetInnerCrust = 0.9f;
+size_t gPlanetChunks = 64;
+
+// Terrain detail
+float gTerrainDetailStep = 8.0f;
+float gTerrainDetailAmplitude = 6.0f;
+float gTerrainDetailInterval = 0.25f;
+float gTerrainDetailMargin = 300.0f;
+float gTerrainDetailMaxZoom = 2.0f;
+size_t gTerrainDetailBudget = 20000;
+size_t gTerrainDetailPerUpdate = 4;
+
+// Sprite atlas
+bool gSpriteAtlasEnabled = true;
+int gSpriteAtlasSize = 2048;
+float gSpriteAtlasScale = 2.0f;
+
+// Debris
+int gDebrisMaxParticles = 4096;
+int gDebrisFragments = 24;
+int gDebrisDamagingFragments = 2;
+float gDebrisMinSpeed = 200.0f;
+float gDebrisMaxSpeed = 500.0f;
+float gDebrisLifetime = 4.0f;
+float gDebrisSize = 3.0f;
+
+// Ballistics
+bool gBallisticShells = true;
+float gBallisticsShellSize = 2.0f;
+float gBallisticsStep = 1.0f / 60;
+float gBallisticsMaxSweep = 10.0f;
+float gBallisticsCrustStep = 4.0f;
+float gBallisticsLifetime = 60.0f;
+
+// Blasts
+size_t gBlastsPerUpdate = 16;
+float gUnitBlastRadius = 30.0f;
+i32 gUnitBlastDamage = 40;
+float gUnitBlastImpulse = 50.0f;
+float gShellBlastRadius = 0.0f;
+i32 gShellBlastDamage = 15;
+float gShellBlastImpulse = 20.0f;
+
+// Visibility
+float gUnitSightRadius = 600.0f;
+float gBuildingSightRadius = 400.0f;
+float gVisibilityCellLength = 50.0f;
+float gVisibilityAirAltitude = 1000.0f;
+float gVisibilityLosStep = 20.0f;
+float gVisibilityUpdateBudget = 0.0005f;
+
+// Fog of war
+bool gFogOfWar = true;
+const cc::Color4F gFogColor(0.0f, 0.0f, 0.0f, 0.6f);
+
+// Orbits
+double gOrbitMaxEccentricity = 0.95;
+float gOrbitMaxPerturbation = 0.05f;
+
+// Galaxy
+ui64 gGalaxySeed = 0;
+size_t gGalaxySystems = 3;
+float gGalaxySystemDistance = 800000.0f;
+int gGalaxyMinPlanets = 2;
+int gGalaxyMaxPlanets = 4;
+int gGalaxyMaxMoons = 2;
+int gGalaxyMinAsteroids = 4;
+int gGalaxyMaxAsteroids = 6;
+size_t gGalaxyThreads = 0;
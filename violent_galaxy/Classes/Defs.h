@@ -34,7 +34,28 @@ class AstroObj;
 class Player;
 struct ContactInfo;
 
-using Id = ui32; // 24 bits max
+// Object handle: index of slot in storage and generation of this slot
+// Slots are recycled, generation lets detect handles to destroyed objects
+using Id = ui32; // 28 bits max
+static constexpr ui32 IdIndexBits = 18;
+static constexpr ui32 IdGenerationBits = 10;
+static constexpr ui32 IdIndexMask = (1u << IdIndexBits) - 1;
+static constexpr ui32 IdGenerationMask = (1u << IdGenerationBits) - 1;
+
+inline Id makeId(ui32 index, ui32 generation)
+{
+    return (generation << IdIndexBits) | index;
+}
+
+inline ui32 idIndex(Id id)
+{
+    return id & IdIndexMask;
+}
+
+inline ui32 idGeneration(Id id)
+{
+    return id >> IdIndexBits;
+}
 
 // Z-COORDINATES (8 bits)
 using Zs = int; // Z-coordinate bitmask; also is used as contact bitmask
@@ -91,6 +112,8 @@ extern const cc::Color4F gHpBgColor;
 extern const cc::Color4F gProdColor;
 extern const cc::Color4F gProdBgColor;
 extern const cc::Color4F gIndicatorBorderColor;
+extern const cc::Color4F gCrustColor;
+extern const cc::Color4F gPlatformColor;
 
 // GUI
 extern const cc::Color4F gPanelBgColor;
@@ -101,6 +124,9 @@ extern float gMiniMapPanelWidth;
 extern float gMiniMapPanelHeight;
 extern float gControlPanelWidth;
 extern float gControlPanelHeight;
+extern float gMiniMapUpdateInterval; // Time between updates of unit and building markers
+extern float gMiniMapMarkerSize;
+extern float gMiniMapRange; // Map radius in space radii of planet under view, e.g. to show its moons
 
 // Z-Order
 extern const int gZOrderMouseSelectionRect;
@@ -108,6 +134,7 @@ extern const int gZOrderIndicators;
 extern const int gZOrderResIcons;
 extern const int gZOrderResLabels;
 extern const int gZOrderSelectionPanel;
+extern const int gZOrderMiniMap;
 
 // Keyboard hotkeys
 static constexpr size_t GRP_COUNT = 10;
@@ -123,10 +150,115 @@ extern cc::EventKeyboard::KeyCode gHKPowerInc;
 extern cc::EventKeyboard::KeyCode gHKPowerDec;
 extern cc::EventKeyboard::KeyCode gHKShoot;
 extern cc::EventKeyboard::KeyCode gHKHold;
+extern cc::EventKeyboard::KeyCode gHKTimeWarpFaster;
+extern cc::EventKeyboard::KeyCode gHKTimeWarpSlower;
 
 // Orders
 extern size_t gMaxOrders;
 extern float gOrderDelayTimeout; // Time after which delayed order fails
+extern float gFormationSpacing; // Distance along surface between neighbour slots of order group
+
+// Pathing
+extern float gFlowFieldMaxSlope; // Sine of the steepest slope unit can climb
+extern float gFlowFieldSlopeCost; // Extra cost per unit of length per unit of slope
+extern float gFlowFieldPlatformCost; // Extra cost of segment with building platform
+extern float gFlowFieldDensityCost; // Extra cost of segment per unit in it
+extern float gFlowFieldTtl; // Time during which field is reused for the same destination
+
+// Simulation clock
+extern int gSimulationRate; // Fixed physics steps per second of game time
+extern int gSimulationMaxSteps; // Physics steps per frame, game slows down if frames take longer than this
+extern bool gSimulationInterpolation; // Render nodes in between two last physics steps
+extern bool gSimulationThread; // Do physics steps on separate thread concurrently with rendering
+
+// Time warp
+static constexpr size_t WARP_COUNT = 4;
+extern float gTimeWarpLevels[WARP_COUNT]; // Fixed integer speeds, level after the last one is max warp
+extern float gTimeWarpMaxSpeed; // Upper bound of speed in max warp, integer
+extern float gTimeWarpMinFps; // Max warp slows down if frame rate falls below this
+extern float gTimeWarpRenderFps; // Frame rate during warp, rendering less often leaves more time for simulation
+
+// Sleeping
+extern float gSleepTimeThreshold; // Time body must be idle to fall asleep
+extern float gIdleSpeedThreshold; // Body moving slower than this is considered idle
+extern float gIdleAngularVelocity; // Unit rotating relative to surface slower than this is considered idle
+
+// Simulation LOD
+extern float gLodUpdateInterval; // Time between unit simulation level checks
+extern float gLodViewMargin; // Units closer than this to visible area are always fully simulated
+extern float gLodEnemyDistance; // Units closer than this to any enemy are always fully simulated
+extern float gLodMaxRadialVelocity; // Units falling or bouncing faster than this are not put on rails
+
+// Planet
+extern float gPlanetInnerCrust; // Part of core radius filled with crust by shader instead of geometry
+extern size_t gPlanetChunks; // Number of angular chunks of planet geometry for view culling
+
+// Terrain detail
+extern float gTerrainDetailStep; // Distance between generated crust points
+extern float gTerrainDetailAmplitude; // Maximum deviation of relief from coarse profile
+extern float gTerrainDetailInterval; // Time between checks which chunks need detail
+extern float gTerrainDetailMargin; // Chunks closer than this to unit are refined
+extern float gTerrainDetailMaxZoom; // Visible chunks are refined only if zoom is below this
+extern size_t gTerrainDetailBudget; // Generated points kept for all planets, least recently used chunks are dropped
+extern size_t gTerrainDetailPerUpdate; // Chunks refined per update, the rest waits, so that zooming in does not stall frame
+
+// Sprite atlas
+extern bool gSpriteAtlasEnabled; // Render units and buildings as sprites from pre-rasterized atlas
+extern int gSpriteAtlasSize; // Width and height of atlas texture
+extern float gSpriteAtlasScale; // Texels per world length unit
+
+// Debris
+extern int gDebrisMaxParticles; // Capacity of particle system shared by all explosions
+extern int gDebrisFragments; // Visual-only fragments thrown by destroyed unit
+extern int gDebrisDamagingFragments; // Fragments that are shells and can hit other units
+extern float gDebrisMinSpeed;
+extern float gDebrisMaxSpeed;
+extern float gDebrisLifetime; // Maximum time visual fragment lives unless it hits surface
+extern float gDebrisSize;
+
+// Ballistics
+extern bool gBallisticShells; // Shells are swept analytically instead of being physics bodies
+extern float gBallisticsShellSize;
+extern float gBallisticsStep; // Maximum integration step of game time
+extern float gBallisticsMaxSweep; // Maximum distance shell passes during one step
+extern float gBallisticsCrustStep; // Distance between crust checks along swept segment
+extern float gBallisticsLifetime; // Shell that has not hit anything disappears after this time
+
+// Blasts
+extern size_t gBlastsPerUpdate; // The rest is resolved later, so that chain explosions do not stall frame
+extern float gUnitBlastRadius; // Added to unit size
+extern i32 gUnitBlastDamage;
+extern float gUnitBlastImpulse;
+extern float gShellBlastRadius; // Zero disables area damage of shells
+extern i32 gShellBlastDamage;
+extern float gShellBlastImpulse;
+
+// Visibility
+extern float gUnitSightRadius;
+extern float gBuildingSightRadius;
+extern float gVisibilityCellLength; // Both height of altitude band and width of cell at terrain level
+extern float gVisibilityAirAltitude; // Cells cover this altitude above the highest terrain
+extern float gVisibilityLosStep; // Distance between terrain checks along line of sight
+extern float gVisibilityUpdateBudget; // Seconds spent on observer footprints per update, the rest waits
+
+// Fog of war
+extern bool gFogOfWar;
+extern const cc::Color4F gFogColor; // Darkening of space that is not seen
+
+// Orbits
+extern double gOrbitMaxEccentricity; // More eccentric orbits are left to physics
+extern float gOrbitMaxPerturbation; // Object leaves orbit if other sources change its gravity by this fraction
+
+// Galaxy
+extern ui64 gGalaxySeed; // Zero is for new galaxy every game
+extern size_t gGalaxySystems;
+extern float gGalaxySystemDistance; // Between home system and other ones
+extern int gGalaxyMinPlanets; // Per system, besides primary planet
+extern int gGalaxyMaxPlanets;
+extern int gGalaxyMaxMoons; // Per planet
+extern int gGalaxyMinAsteroids; // Per system
+extern int gGalaxyMaxAsteroids;
+extern size_t gGalaxyThreads; // Workers generating terrain, zero is for one per hardware core
 
 // TODO[fate]: move to some sort of util
 // Returns x = a + 2*pi*n, where n is integer and x is in [0; 2*pi)
@@ -178,3 +310,36 @@ inline int ZsOrder(Zs zs)
         return -1; // ZsNone
     }
 }
+
+// Deterministic random number generator (splitmix64). Unlike global cocos random it may be used
+// concurrently: every thread or generated object takes its own stream derived from seed
+class Rng {
+public:
+    explicit Rng(ui64 seed, ui64 stream = 0)
+        : _state(seed ^ (stream * 0xD1B54A32D192ED03ull))
+    {
+        next(); // Mix seed, so that close seeds give unrelated sequences
+    }
+
+    ui64 next()
+    {
+        ui64 z = (_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniformly distributed in [a; b)
+    float uniform(float a, float b)
+    {
+        return a + (b - a) * float(next() >> 40) / float(1ull << 24);
+    }
+
+    // Uniformly distributed in [a; b]
+    int uniformInt(int a, int b)
+    {
+        return a + int(next() % ui64(b - a + 1));
+    }
+private:
+    ui64 _state;
+};
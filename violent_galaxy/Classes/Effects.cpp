@@ -0,0 +1,119 @@
+#include "Effects.h"
+#include "GameScene.h"
+
+USING_NS_CC;
+
+DebrisSystem* DebrisSystem::create(GameScene* game)
+{
+    DebrisSystem* ret = new (std::nothrow) DebrisSystem();
+    if (ret && ret->init(game)) {
+        ret->autorelease();
+        return ret;
+    }
+    delete ret;
+    return nullptr;
+}
+
+bool DebrisSystem::init(GameScene* game)
+{
+    _game = game;
+    if (!initWithTotalParticles(gDebrisMaxParticles)) {
+        return false;
+    }
+
+    // Fragments are plain colored squares
+    static const unsigned char white[2 * 2 * 4] = {
+        255, 255, 255, 255,  255, 255, 255, 255,
+        255, 255, 255, 255,  255, 255, 255, 255
+    };
+    auto texture = new (std::nothrow) Texture2D();
+    texture->initWithData(white, sizeof(white), Texture2D::PixelFormat::RGBA8888, 2, 2, Size(2, 2));
+    setTexture(texture);
+    texture->release();
+
+    // Particles are never emitted by system itself, they are added by explode()
+    setDuration(DURATION_INFINITY);
+    setEmissionRate(0.0f);
+    setPositionType(PositionType::GROUPED); // Particle positions are world positions
+    setCameraMask((unsigned short)gWorldCameraFlag);
+    return true;
+}
+
+void DebrisSystem::explode(Vec2 p, Vec2 up, Color4F color, int count)
+{
+    ParticleData& d = _particleData;
+    for (int k = 0; k < count && _particleCount < _totalParticles; k++) {
+        int i = _particleCount++;
+        d.posx[i] = p.x;
+        d.posy[i] = p.y;
+        d.startPosX[i] = p.x;
+        d.startPosY[i] = p.y;
+
+        float angle = CC_DEGREES_TO_RADIANS(random<float>(-60, 60));
+        Vec2 v = up.rotateByAngle(Vec2::ZERO, angle) * random<float>(gDebrisMinSpeed, gDebrisMaxSpeed);
+        d.modeA.dirX[i] = v.x;
+        d.modeA.dirY[i] = v.y;
+
+        float ttl = gDebrisLifetime * random<float>(0.5f, 1.0f);
+        d.timeToLive[i] = ttl;
+        d.colorR[i] = color.r;
+        d.colorG[i] = color.g;
+        d.colorB[i] = color.b;
+        d.colorA[i] = color.a;
+        d.deltaColorR[i] = 0.0f;
+        d.deltaColorG[i] = 0.0f;
+        d.deltaColorB[i] = 0.0f;
+        d.deltaColorA[i] = -color.a / ttl; // Fade out until death
+        d.size[i] = gDebrisSize * random<float>(0.5f, 1.0f);
+        d.deltaSize[i] = 0.0f;
+        d.rotation[i] = random<float>(0.0f, 360.0f);
+        d.deltaRotation[i] = random<float>(-720.0f, 720.0f);
+    }
+}
+
+void DebrisSystem::update(float dt)
+{
+    dt *= _game->physicsWorld()->getSpeed(); // Keep up with time warp
+    if (_particleCount > 0) {
+        const std::vector<Planet*>& planets = _game->planets();
+
+        ParticleData& d = _particleData;
+        PhysicsForceField* ffield = _game->physicsWorld()->getForceField();
+        for (int i = 0; i < _particleCount; ) {
+            d.timeToLive[i] -= dt;
+            Vec2 p(d.posx[i], d.posy[i]);
+            bool alive = d.timeToLive[i] > 0.0f;
+            for (Planet* planet : planets) {
+                if (!alive) {
+                    break;
+                }
+                Polar polar = planet->world2polar(p);
+                alive = polar.r > planet->getCoreRadius() + planet->getAltitudeAt(polar.a);
+            }
+            if (!alive) {
+                // Order of particles does not matter, so fill the hole with the last one
+                if (i != _particleCount - 1) {
+                    d.copyParticle(i, _particleCount - 1);
+                }
+                _particleCount--;
+                continue;
+            }
+
+            // Semi-implicit Euler is good enough for something that lives few seconds
+            Vec2 g = ffield->getGravity(p);
+            d.modeA.dirX[i] += g.x * dt;
+            d.modeA.dirY[i] += g.y * dt;
+            d.posx[i] += d.modeA.dirX[i] * dt;
+            d.posy[i] += d.modeA.dirY[i] * dt;
+            d.colorA[i] = std::max(0.0f, d.colorA[i] + d.deltaColorA[i] * dt);
+            d.rotation[i] += d.deltaRotation[i] * dt;
+            i++;
+        }
+    }
+
+    updateParticleQuads();
+    _transformSystemDirty = false;
+    if (_visible) {
+        postStep();
+    }
+}
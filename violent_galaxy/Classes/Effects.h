@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Defs.h"
+
+class GameScene;
+
+// Visual-only explosion fragments. All fragments in the world are kept in single particle
+// system, so they are drawn in one draw call and integrated in bulk under planet gravity
+// without any physics bodies. Fragment dies when it hits planet surface or gets too old
+class DebrisSystem : public cc::ParticleSystemQuad {
+public:
+    static DebrisSystem* create(GameScene* game);
+
+    // Throws count fragments from world point p into the cone around up direction
+    void explode(cc::Vec2 p, cc::Vec2 up, cc::Color4F color, int count);
+
+    void update(float dt) override;
+protected:
+    DebrisSystem() {}
+    bool init(GameScene* game);
+private:
+    GameScene* _game = nullptr;
+};
@@ -0,0 +1,118 @@
+#include "FlowField.h"
+#include "GameScene.h"
+
+#include <queue>
+
+USING_NS_CC;
+
+FlowField::FlowField(GameScene* game, Planet* planet, float dstAngle)
+    : _planetId(planet->getId())
+    , _dstAngle(angleMain(dstAngle))
+    , _size(planet->segments().size())
+    , _astep(2 * M_PI / _size)
+    , _dst(locate(dstAngle))
+{
+    build(game, planet);
+}
+
+int FlowField::getDirection(float a) const
+{
+    return _dir[locate(a)];
+}
+
+bool FlowField::isDestination(float a) const
+{
+    return locate(a) == _dst;
+}
+
+bool FlowField::isReachable(float a) const
+{
+    return _cost[locate(a)] < std::numeric_limits<float>::infinity();
+}
+
+size_t FlowField::locate(float a) const
+{
+    // Same rounding as in AngularVec::locate()
+    return (size_t)((i64)floorf(angleMain(a) / _astep) % _size);
+}
+
+void FlowField::build(GameScene* game, Planet* planet)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const AngularVec<Segment>& segments = planet->segments();
+    size_t size = _size;
+
+    // Cost of driving through every segment. Steep segments cannot be entered, but they are still
+    // left by units standing on them and reached if destination is there
+    std::vector<float> through(size, 0.0f);
+    std::vector<bool> steep(size, false);
+    for (size_t i = 0; i < size; i++) {
+        const Segment& seg = segments[i];
+        float length = 0.0f;
+        float slope = 0.0f;
+        const GeoPoint* pt1 = &seg.pts.front();
+        for (size_t j = 1; j <= seg.pts.size(); j++) {
+            const GeoPoint* pt2 = (j < seg.pts.size()? &seg.pts[j]: &seg.next->pts.front());
+            Vec2 v1 = planet->altAng2local(pt1->altitude, pt1->angle);
+            Vec2 v2 = planet->altAng2local(pt2->altitude, pt2->angle);
+            float chord = (v2 - v1).length();
+            if (chord > 0.0f) {
+                slope = std::max(slope, fabsf(pt2->altitude - pt1->altitude) / chord);
+            }
+            length += chord;
+            pt1 = pt2;
+        }
+        steep[i] = (slope > gFlowFieldMaxSlope); // Too steep to climb
+        through[i] = length * (1.0f + gFlowFieldSlopeCost * std::min(slope, gFlowFieldMaxSlope));
+    }
+
+    // Buildings stand on platforms, avoid driving under them if possible
+    for (const Platform& platform : planet->platforms()) {
+        size_t i1 = locate(platform.pts[0].getAngle());
+        size_t i2 = locate(platform.pts[1].getAngle());
+        if ((i2 + size - i1) % size > size / 2) {
+            std::swap(i1, i2); // Platform is the shorter arc whatever order its points are in
+        }
+        for (size_t i = i1; ; i = (i + 1) % size) {
+            through[i] += gFlowFieldPlatformCost;
+            if (i == i2) {
+                break;
+            }
+        }
+    }
+
+    // Crowded segments are more expensive to drive through
+    for (Vec2 p : game->surfaceUnitPositions(planet)) {
+        Polar polar = planet->world2polar(p);
+        through[locate(polar.a)] += gFlowFieldDensityCost;
+    }
+
+    // Dijkstra from destination over ring of segments
+    _cost.assign(size, inf);
+    _dir.assign(size, 0);
+    using Item = std::pair<float, size_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    _cost[_dst] = 0.0f;
+    queue.emplace(0.0f, _dst);
+    while (!queue.empty()) {
+        Item item = queue.top();
+        queue.pop();
+        size_t i = item.second;
+        if (item.first > _cost[i]) {
+            continue; // Outdated queue item
+        }
+        size_t neighbours[2] = { (i + 1) % size, (i + size - 1) % size };
+        if (steep[i] && i != _dst) {
+            continue; // Is left by units standing on it, but never entered
+        }
+        for (size_t j : neighbours) {
+            float cost = _cost[i] + (through[i] + through[j]) / 2;
+            if (cost < _cost[j]) {
+                _cost[j] = cost;
+                // Units in j-th segment should move toward i-th segment
+                _dir[j] = (j == neighbours[0]? -1: 1);
+                queue.emplace(cost, j);
+            }
+        }
+    }
+}
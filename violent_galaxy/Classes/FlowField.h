@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Defs.h"
+
+#include <vector>
+
+class Planet;
+
+// Navigation field over planet surface segments toward a single destination.
+// Built once per destination and shared by every unit that moves there
+class FlowField {
+public:
+    FlowField(GameScene* game, Planet* planet, float dstAngle);
+
+    Id getPlanetId() const { return _planetId; }
+    float getDstAngle() const { return _dstAngle; }
+
+    // Returns +1 to move toward greater angles, -1 toward smaller angles
+    // and 0 if unit is in destination segment or destination is unreachable
+    int getDirection(float a) const;
+    bool isDestination(float a) const;
+    bool isReachable(float a) const;
+private:
+    size_t locate(float a) const;
+    void build(GameScene* game, Planet* planet);
+private:
+    Id _planetId;
+    float _dstAngle;
+    size_t _size;
+    float _astep;
+    size_t _dst;
+    std::vector<float> _cost; // segment idx -> total cost to reach destination
+    std::vector<i8> _dir; // segment idx -> direction of movement
+};
@@ -0,0 +1,137 @@
+#include "FogOfWar.h"
+#include "GameScene.h"
+
+USING_NS_CC;
+
+// Darkens cells of polar grid that are not seen, texture coords of mask are (angle, altitude band)
+static const GLchar* fogFrag = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform sampler2D u_mask;
+uniform vec2 u_radii; // Grid inner and outer radii relative to quad radius
+uniform vec4 u_fogColor;
+
+void main()
+{
+    vec2 p = vec2(v_texCoord.x * 2.0 - 1.0, 1.0 - v_texCoord.y * 2.0);
+    float r = length(p);
+    if (r < u_radii.x || r >= u_radii.y) {
+        discard;
+    }
+    float a = atan(p.y, p.x);
+    if (a < 0.0) {
+        a += 6.2831853;
+    }
+    float seen = texture2D(u_mask, vec2(a / 6.2831853, (r - u_radii.x) / (u_radii.y - u_radii.x))).a;
+    gl_FragColor = u_fogColor * (1.0 - seen);
+}
+)";
+
+static GLProgram* fogProgram()
+{
+    static const char* key = "violent_galaxy.fog";
+    GLProgram* program = GLProgramCache::getInstance()->getGLProgram(key);
+    if (!program) {
+        program = GLProgram::createWithByteArrays(ccPositionTextureColor_noMVP_vert, fogFrag);
+        GLProgramCache::getInstance()->addGLProgram(program, key);
+    }
+    return program;
+}
+
+void FogOfWar::init(GameScene* game)
+{
+    _game = game;
+    Visibility* visibility = _game->visibility();
+    _masks.resize(visibility->getLayerCount());
+    for (size_t li = 0; li < _masks.size(); li++) {
+        Mask& mask = _masks[li];
+        float r1;
+        float r2;
+        visibility->getLayerGeometry(li, r1, r2, mask.rsize, mask.asize);
+        mask.data.assign(mask.rsize * mask.asize, 0);
+        auto texture = new (std::nothrow) Texture2D();
+        texture->initWithData(mask.data.data(), mask.data.size(), Texture2D::PixelFormat::A8,
+                              (int)mask.asize, (int)mask.rsize, Size(mask.asize, mask.rsize));
+        mask.texture = texture;
+        texture->release(); // Owned by RefPtr
+
+        // Whole default 2x2 white texture is used, so texture coords span [0; 1]
+        Planet* planet = _game->objs()->getByIdAs<Planet>(visibility->getLayerPlanetId(li));
+        mask.node = Sprite::create();
+        mask.node->setTextureRect(Rect(0, 0, 2, 2));
+        mask.node->setScale(r2);
+        GLProgramState* state = GLProgramState::create(fogProgram());
+        state->setUniformTexture("u_mask", texture);
+        state->setUniformVec2("u_radii", Vec2(r1 / r2, 1.0f));
+        state->setUniformVec4("u_fogColor", Vec4(gFogColor.r, gFogColor.g, gFogColor.b, gFogColor.a));
+        mask.node->setGLProgramState(state);
+        mask.node->setVisible(false);
+        mask.node->setCameraMask(planet->getNode()->getCameraMask());
+        planet->getNode()->addChild(mask.node, 1); // Over crust
+    }
+}
+
+void FogOfWar::addTarget(VisualObj* obj)
+{
+    _targets.emplace(obj->getId(), Target());
+}
+
+void FogOfWar::removeTarget(Id objId)
+{
+    _targets.erase(objId);
+}
+
+void FogOfWar::update(float delta)
+{
+    Player* player = _game->activePlayer();
+    Visibility* visibility = _game->visibility();
+
+    // Seen cells are looked up only for enemy targets that moved to another cell or whose cell may have
+    // changed visibility. Flags are toggled only for targets that change visibility, so nodes are left untouched otherwise
+    for (auto& kv : _targets) {
+        Target& target = kv.second;
+        VisualObj* vobj = _game->objs()->getByIdAs<VisualObj>(kv.first);
+        Player* owner = vobj->getPlayer();
+        bool fog = gFogOfWar && player && owner != player;
+        ui64 cellKey = 0;
+        ui64 cellVersion = 0;
+        if (fog) {
+            visibility->getCellState(player, vobj->getNode()->getPosition(), cellKey, cellVersion);
+        }
+        if (target.checked && target.player == player && target.owner == owner && target.fog == fog
+            && target.cellKey == cellKey && target.cellVersion == cellVersion) {
+            continue;
+        }
+        target.checked = true;
+        target.player = player;
+        target.owner = owner;
+        target.fog = fog;
+        target.cellKey = cellKey;
+        target.cellVersion = cellVersion;
+        bool hidden = fog && !visibility->isVisible(player, vobj->getNode()->getPosition());
+        if (vobj->isFogHidden() != hidden) {
+            vobj->setFogHidden(hidden);
+        }
+    }
+
+    for (size_t li = 0; li < _masks.size(); li++) {
+        Mask& mask = _masks[li];
+        mask.node->setVisible(gFogOfWar && player);
+        if (!mask.node->isVisible()) {
+            continue;
+        }
+        ui64 version = visibility->getLayerVersion(li, player);
+        if (player == _player && version == mask.version) {
+            continue;
+        }
+        mask.version = version;
+        visibility->getLayerMask(li, player, mask.data.data());
+        mask.texture->updateWithData(mask.data.data(), 0, 0, (int)mask.asize, (int)mask.rsize);
+    }
+    _player = player;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Defs.h"
+#include "base/CCRefPtr.h"
+
+#include <unordered_map>
+#include <vector>
+
+class GameScene;
+class Player;
+class VisualObj;
+
+// Fog of war of active player. Enemy units and buildings that are not seen by active player are hidden by flag,
+// their nodes stay in scene. Space around planets is darkened by shader using mask texture
+// of seen cells, texture is updated in place only when set of seen cells changes
+class FogOfWar {
+public:
+    void init(GameScene* game);
+    void update(float delta);
+
+    // Called by foggable objects on init and destroy
+    void addTarget(VisualObj* obj);
+    void removeTarget(Id objId);
+private:
+    // Visibility of target is rechecked only if anything it depends on has changed since the last check
+    struct Target {
+        Player* player = nullptr; // Active player
+        Player* owner = nullptr;
+        bool fog = false;
+        ui64 cellKey = 0;
+        ui64 cellVersion = 0;
+        bool checked = false;
+    };
+
+    struct Mask {
+        cc::RefPtr<cc::Texture2D> texture;
+        cc::Sprite* node = nullptr;
+        ui64 version = 0;
+        size_t rsize = 0;
+        size_t asize = 0;
+        std::vector<ui8> data;
+    };
+private:
+    GameScene* _game = nullptr;
+    Player* _player = nullptr; // Masks are drawn for this player
+    std::vector<Mask> _masks; // One per visibility layer
+    std::unordered_map<Id, Target> _targets;
+};
@@ -0,0 +1,118 @@
+#include "Galaxy.h"
+
+USING_NS_CC;
+
+GalaxyGenerator::GalaxyGenerator(size_t threads)
+    : _pool(threads)
+    , _done(0)
+{}
+
+GalaxyGenerator::~GalaxyGenerator()
+{
+    _pool.cancel();
+    _pool.wait();
+}
+
+void GalaxyGenerator::start(ui64 seed, size_t systems)
+{
+    _galaxy.seed = seed;
+    _galaxy.planets.clear();
+    _done = 0;
+
+    Rng rng(seed);
+    for (size_t s = 0; s < systems; s++) {
+        Vec2 center = Vec2::ZERO;
+        if (s > 0) { // Home system is in the middle, others are around it
+            float a = 2 * M_PI * (s - 1) / (systems - 1) + rng.uniform(-0.3f, 0.3f);
+            center = gGalaxySystemDistance * rng.uniform(0.8f, 1.2f) * Vec2::forAngle(a);
+        }
+        layoutSystem(rng, center, s == 0);
+    }
+
+    // Bodies are not added anymore, so jobs may keep pointers to descriptions
+    for (PlanetDesc& desc : _galaxy.planets) {
+        PlanetDesc* pdesc = &desc;
+        _pool.submit([this, pdesc] {
+            pdesc->generate();
+            _done++;
+        });
+    }
+}
+
+bool GalaxyGenerator::isDone()
+{
+    return _pool.pending() == 0;
+}
+
+float GalaxyGenerator::getProgress()
+{
+    return _galaxy.planets.empty()? 1.0f: float(_done) / _galaxy.planets.size();
+}
+
+GalaxyDesc GalaxyGenerator::take()
+{
+    _pool.wait();
+    return std::move(_galaxy);
+}
+
+void GalaxyGenerator::layoutSystem(Rng& rng, Vec2 center, bool home)
+{
+    // Primary planet, home one keeps size game is balanced for
+    addBody(rng, center, home? 6000: rng.uniform(4000, 8000));
+
+    // Planets, orbit radius grows with every planet
+    float orbitRadius = 0;
+    int planets = rng.uniformInt(gGalaxyMinPlanets, gGalaxyMaxPlanets);
+    for (int i = 0; i < planets; i++) {
+        orbitRadius += rng.uniform(50000, 70000);
+        Vec2 p = center + orbitRadius * Vec2::forAngle(rng.uniform(0, 2 * M_PI));
+        float coreRadius = rng.uniform(2000, 5000);
+        PlanetDesc& desc = addBody(rng, p, coreRadius);
+        float moonsRadius = coreRadius + desc.spacAltitude;
+
+        int moons = rng.uniformInt(0, gGalaxyMaxMoons);
+        for (int j = 0; j < moons; j++) {
+            moonsRadius += rng.uniform(4000, 6000);
+            Vec2 pm = p + moonsRadius * Vec2::forAngle(rng.uniform(0, 2 * M_PI));
+            PlanetDesc& moon = addBody(rng, pm, rng.uniform(600, 1500));
+            moon.mountainCount = 30;
+            moon.mountainHeight = 150;
+            moon.depositCount = 10;
+        }
+    }
+
+    // Asteroid belt outside of planets
+    float beltRadius = orbitRadius + rng.uniform(40000, 50000);
+    int asteroids = rng.uniformInt(gGalaxyMinAsteroids, gGalaxyMaxAsteroids);
+    float beltAngle = rng.uniform(0, 2 * M_PI);
+    for (int i = 0; i < asteroids; i++) {
+        float a = beltAngle + 2 * M_PI * i / asteroids + rng.uniform(-0.1f, 0.1f);
+        float r = beltRadius + rng.uniform(-2000, 2000);
+        PlanetDesc& desc = addBody(rng, center + r * Vec2::forAngle(a), rng.uniform(150, 400));
+        desc.atmoAltitude = 100;
+        desc.spacAltitude = 500;
+        desc.mountainCount = 10;
+        desc.mountainHeight = 60;
+        desc.depositCount = 2;
+    }
+}
+
+PlanetDesc& GalaxyGenerator::addBody(Rng& rng, Vec2 position, float coreRadius)
+{
+    _galaxy.planets.emplace_back();
+    PlanetDesc& desc = _galaxy.planets.back();
+    desc.seed = rng.next();
+    desc.position = position;
+    desc.coreRadius = coreRadius;
+
+    // Mass grows with area to keep surface gravity the same order as on home planet
+    float scale = coreRadius / 6000;
+    desc.mass = 1e10 * scale * scale;
+    desc.moment = 1e12 * scale * scale * scale * scale;
+
+    // Smaller bodies have proportionally thinner atmosphere and space around
+    desc.atmoAltitude = std::max(200.0f, 1500 * scale);
+    desc.spacAltitude = std::max(1000.0f, 6000 * scale);
+    desc.mountainCount = std::max(10, int(100 * scale));
+    return desc;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Defs.h"
+#include "AstroObjs.h"
+#include "JobPool.h"
+
+#include <atomic>
+#include <vector>
+
+struct GalaxyDesc {
+    ui64 seed = 0;
+    std::vector<PlanetDesc> planets; // The first one is home planet
+};
+
+// Procedural galaxy made of star systems. Every system is a cluster of planets with moons and
+// an asteroid belt around its primary planet. Layout is cheap and is done on calling thread,
+// terrain of every body is generated by its own job from its own random stream, so that
+// result depends only on seed and not on number of threads or order of jobs
+class GalaxyGenerator {
+public:
+    explicit GalaxyGenerator(size_t threads = gGalaxyThreads);
+    ~GalaxyGenerator(); // Jobs refer to descriptions, so they are stopped before descriptions are freed
+
+    void start(ui64 seed, size_t systems);
+    bool isDone();
+    float getProgress(); // Part of bodies generated, from 0 to 1
+    GalaxyDesc take(); // Waits for all bodies to be generated
+private:
+    void layoutSystem(Rng& rng, cc::Vec2 center, bool home);
+    PlanetDesc& addBody(Rng& rng, cc::Vec2 position, float coreRadius);
+private:
+    JobPool _pool;
+    GalaxyDesc _galaxy;
+    std::atomic<size_t> _done;
+};
@@ -7,23 +7,32 @@
 
 USING_NS_CC;
 
-Scene* GameScene::createScene()
+Scene* GameScene::createScene(GalaxyDesc&& galaxy)
 {
     // 'scene' is an autorelease object
     auto scene = Scene::createWithPhysics();
 //    scene->getPhysicsWorld()->setDebugDrawMask(PhysicsWorld::DEBUGDRAW_ALL, (unsigned short)gWorldCameraFlag);
     scene->getPhysicsWorld()->setGravity(Vec2::ZERO);
+    scene->getPhysicsWorld()->setSleepTimeThreshold(gSleepTimeThreshold);
+    scene->getPhysicsWorld()->setIdleSpeedThreshold(gIdleSpeedThreshold);
+    scene->getPhysicsWorld()->setFixedUpdateRate(gSimulationRate);
+    scene->getPhysicsWorld()->setMaxFixedSteps(gSimulationMaxSteps);
+    scene->getPhysicsWorld()->setInterpolation(gSimulationInterpolation);
 
     auto ffield = PhysicsForceField::create();
     scene->getPhysicsWorld()->setForceField(ffield);
 
     // 'layer' is an autorelease object
     auto layer = GameScene::create();
-    layer->createWorld(scene, scene->getPhysicsWorld());
+    layer->createWorld(scene, scene->getPhysicsWorld(), galaxy);
 
     // add layer as a child to scene
     scene->addChild(layer);
 
+    // Solver steps are done concurrently with rendering
+    scene->getPhysicsWorld()->setContactFilter(CC_CALLBACK_1(GameScene::acceptContact, layer));
+    scene->getPhysicsWorld()->setAsyncStep(gSimulationThread);
+
     // return the scene
     return scene;
 }
@@ -60,6 +69,7 @@ bool GameScene::init()
 //    addChild(label, 1);
 
     _objs = ObjStorage::create();
+    _atlas.init();
     scheduleUpdate();
 
     return true;
@@ -67,25 +77,42 @@ bool GameScene::init()
 
 void GameScene::update(float delta)
 {
+    // View and GUI live in real time, everything else is sped up by time warp
+    float realDelta = delta;
+    timeWarpUpdate(realDelta);
+    delta *= _timeWarpSpeed;
+
+    _time += delta;
+
     // Remove dead objs
     for (Obj* obj : _deadObjs) {
         obj->destroy();
     }
     _deadObjs.clear();
+    _objs->compact();
 
-    // Tile grid
+    commandsUpdate();
+
+    lodUpdate(delta);
+    _orbits.update(delta);
+
+    // Tile grid and surface lists
     _unitGrid.clear();
-    for (auto kv : *_objs) {
-        Obj* obj = kv.second;
+    for (auto& kv : _surfaceUnits) {
+        kv.second.clear();
+    }
+    for (Obj* obj : *_objs) {
         if (Unit* unit = dynamic_cast<Unit*>(obj)) {
             Vec2 p = unit->getNode()->getPhysicsBody()->getPosition();
             _unitGrid.add(unit, p, unit->getSize() / 2);
+            if (unit->surfaceId) {
+                _surfaceUnits[unit->surfaceId].push_back(p);
+            }
         }
     }
 
     // Push overlapping units
-    for (auto kv : *_objs) {
-        Obj* obj = kv.second;
+    for (Obj* obj : *_objs) {
         if (Unit* u = dynamic_cast<Unit*>(obj)) {
             auto body = u->getNode()->getPhysicsBody();
             Vec2 p = body->getPosition();
@@ -114,23 +141,210 @@ void GameScene::update(float delta)
                 }
                 return true;
             });
+            if (!u->sepDir.isZero()) {
+                u->wake();
+            }
         }
     }
 
+    // Shells are swept against tile grid, so no unit must be destroyed since it was filled
+    _ballistics.update(delta);
+    _blasts.update(delta);
+
     // Update
     Layer::update(delta);
     playerUpdate(delta);
     keyboardUpdate(delta);
+    orderGroupsUpdate(delta);
+    captureUpdate(delta);
 
-    for (auto kv : *_objs) {
-        Obj* obj = kv.second;
+    for (Obj* obj : *_objs) {
         obj->update(delta);
     }
+    _visibility.update(delta);
+    _fogOfWar.update(delta);
+
+    _view.update(realDelta);
+    _terrain.update(realDelta);
+    cullUpdate();
+    guiUpdate(realDelta);
+    _atlas.flush();
+}
 
-    _view.update(delta);
-    guiUpdate(delta);
+void GameScene::cullUpdate()
+{
+    for (Obj* obj : *_objs) {
+        if (VisualObj* vobj = dynamic_cast<VisualObj*>(obj)) {
+            vobj->cull(_view);
+        }
+    }
 }
 
+void GameScene::captureUpdate(float delta)
+{
+    _captureBuildings.clear();
+    _capturePoints.clear();
+    _captureDistances.clear();
+    _captureMasks.clear();
+    for (Obj* obj : *_objs) {
+        if (Building* building = dynamic_cast<Building*>(obj)) {
+            _captureBuildings.push_back(building);
+            _capturePoints.push_back(building->getNode()->getPosition());
+            _captureDistances.push_back(CaptureChecker::queryDistance(building));
+            _captureMasks.push_back(ZsBackground | ZsForeground); // Units are on one of these
+        }
+    }
+    _pworld->queryPoints(_captureBuildings.size(), _capturePoints.data(), _captureDistances.data(),
+                         _captureMasks.data(), _captureOffsets, _captureShapes);
+    for (size_t i = 0; i < _captureBuildings.size(); i++) {
+        _captureBuildings[i]->captureUpdate(delta, _captureShapes.data() + _captureOffsets[i],
+                                            _captureOffsets[i + 1] - _captureOffsets[i]);
+    }
+}
+
+void GameScene::timeWarpSet(size_t level)
+{
+    _timeWarpLevel = std::min(level, WARP_COUNT); // WARP_COUNT stands for max warp
+    _timeWarpSpeed = gTimeWarpLevels[std::min(_timeWarpLevel, WARP_COUNT - 1)];
+    _pworld->setSpeed(_timeWarpSpeed);
+
+    // Physics world keeps accuracy by doing more substeps, so render less often to save time for them
+    auto director = Director::getInstance();
+    if (_normalAnimationInterval == 0.0f) {
+        _normalAnimationInterval = director->getAnimationInterval();
+    }
+    director->setAnimationInterval(_timeWarpSpeed > 1.0f? 1.0f / gTimeWarpRenderFps: _normalAnimationInterval);
+}
+
+void GameScene::timeWarpFaster()
+{
+    timeWarpSet(_timeWarpLevel + 1);
+}
+
+void GameScene::timeWarpSlower()
+{
+    if (_timeWarpLevel > 0) {
+        timeWarpSet(_timeWarpLevel - 1);
+    }
+}
+
+void GameScene::timeWarpUpdate(float delta)
+{
+    if (_timeWarpLevel == WARP_COUNT) {
+        // Max warp goes as fast as possible while frame rate is acceptable.
+        // Speed is kept integer, so physics does the same solver steps as at normal speed
+        if (delta > 1.0f / gTimeWarpMinFps) {
+            _timeWarpSpeed = std::max(gTimeWarpLevels[WARP_COUNT - 1], roundf(_timeWarpSpeed * 0.8f));
+        } else {
+            _timeWarpSpeed = std::min(gTimeWarpMaxSpeed, roundf(_timeWarpSpeed * 1.1f));
+        }
+        _pworld->setSpeed(_timeWarpSpeed);
+    }
+
+    if (!_timeWarpLabel) {
+        auto s = Director::getInstance()->getVisibleSize();
+        _timeWarpLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+        _timeWarpLabel->setPosition(Vec2(s.width / 2, s.height - 15));
+        this->addChild(_timeWarpLabel, gZOrderResLabels);
+    }
+    _timeWarpLabel->setVisible(_timeWarpSpeed > 1.0f);
+    if (_timeWarpLabel->isVisible()) {
+        std::stringstream ss;
+        ss << "Time warp " << (_timeWarpLevel == WARP_COUNT? "max ": "") << "x" << (int)roundf(_timeWarpSpeed);
+        _timeWarpLabel->setString(ss.str());
+    }
+}
+
+void GameScene::postCommand(const Command& command)
+{
+    _commands.push_back(command);
+}
+
+void GameScene::postMouseCommand(Event* event, void (GameScene::*handler)(Event*))
+{
+    // Event object is reused by view for next events, so handler gets a copy
+    auto copy = std::make_shared<EventMouse>(*static_cast<EventMouse*>(event));
+    postCommand([=] { (this->*handler)(copy.get()); });
+}
+
+void GameScene::commandsUpdate()
+{
+    // Commands posted by other commands are executed on the next update
+    std::vector<Command> commands;
+    commands.swap(_commands);
+    for (const Command& command : commands) {
+        command();
+    }
+}
+
+void GameScene::lodUpdate(float delta)
+{
+    _lodElapsed += delta;
+    bool check = (_lodElapsed >= gLodUpdateInterval);
+    if (check) {
+        _lodElapsed = 0.0f;
+        _lodGrid.clear();
+        for (Obj* obj : *_objs) {
+            if (Unit* unit = dynamic_cast<Unit*>(obj)) {
+                Vec2 p = unit->getNode()->getPhysicsBody()->getPosition();
+                _lodGrid.add(unit, p, gLodEnemyDistance / 2);
+            }
+        }
+    }
+
+    Vec2 viewCenter = _view.getCenter();
+    float viewRadius = _view.getRadius() + gLodViewMargin;
+    for (Obj* obj : *_objs) {
+        Unit* unit = dynamic_cast<Unit*>(obj);
+        if (unit && unit->canUseOrbit()) {
+            // Orbiters are put back on orbit as soon as they are on a bound one and nothing pushes them
+            bool onOrbit = _orbits.contains(unit->getId());
+            if (onOrbit && unit->railsLeaveRequested) {
+                _orbits.leave(unit);
+                unit->railsLeaveRequested = false;
+            } else if (!onOrbit && check) {
+                if (unit->railsLeaveRequested) {
+                    unit->railsLeaveRequested = false;
+                } else if (!unit->surfaceId) { // Landed units are not on orbit
+                    _orbits.enter(unit);
+                }
+            }
+            continue;
+        }
+        if (!unit || !unit->canUseRails()) {
+            continue;
+        }
+        if (unit->isOnRails() && unit->railsLeaveRequested) {
+            unit->railsLeave();
+            continue;
+        }
+        if (!check) {
+            continue;
+        }
+
+        // Units are fully simulated if somebody can see them or shoot them
+        Vec2 p = unit->getNode()->getPhysicsBody()->getPosition();
+        bool near = (p - viewCenter).lengthSquared() < viewRadius * viewRadius;
+        if (!near) {
+            _lodGrid.query(p, gLodEnemyDistance / 2, [=, &near] (Unit* u2, Vec2, float, float) -> bool {
+                if (u2->getPlayer() != unit->getPlayer()) {
+                    near = true;
+                    return false;
+                }
+                return true;
+            });
+        }
+        if (unit->isOnRails()) {
+            if (near) {
+                unit->railsLeave();
+            }
+        } else {
+            if (!near) {
+                unit->railsEnter();
+            }
+        }
+    }
+}
 
 void GameScene::menuCloseCallback(Ref* pSender)
 {
@@ -141,13 +355,21 @@ void GameScene::menuCloseCallback(Ref* pSender)
 #endif
 }
 
-void GameScene::createWorld(Scene* scene, PhysicsWorld* pworld)
+void GameScene::createWorld(Scene* scene, PhysicsWorld* pworld, GalaxyDesc& galaxy)
 {
     _pworld = pworld;
     pworld->setSpeed(1.0);
 
     _view.init(this);
-    initGalaxy();
+    initGalaxy(galaxy);
+    _debris = DebrisSystem::create(this);
+    addChild(_debris, ZsOrder(ZsProjectileDefault));
+    _ballistics.init(this);
+    _blasts.init(this);
+    _visibility.init(this);
+    _fogOfWar.init(this);
+    _orbits.init(this);
+    _terrain.init(this, &_view);
     initCollisions();
 
     initPlayers();
@@ -162,65 +384,80 @@ void GameScene::initKeyboard()
     createKeyHoldHandler();
     auto keyboardListener = EventListenerKeyboard::create();
     keyboardListener->onKeyPressed = [=](EventKeyboard::KeyCode keyCode, Event* event) {
-        switch (keyCode) {
-        case EventKeyboard::KeyCode::KEY_Q:
-            if (isKeyHeld(EventKeyboard::KeyCode::KEY_CTRL) && isKeyHeld(EventKeyboard::KeyCode::KEY_SHIFT)) {
-                menuCloseCallback(this);
-            }
-            break;
-        default:
-            break;
+        postCommand([=] { onKeyPressed(keyCode); });
+    };
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(keyboardListener, this);
+//    _eventDispatcher->addEventListenerWithFixedPriority(keyboardListener, 1);
+    createKeyHistoryHandler();
+}
+
+void GameScene::onKeyPressed(EventKeyboard::KeyCode keyCode)
+{
+    switch (keyCode) {
+    case EventKeyboard::KeyCode::KEY_Q:
+        if (isKeyHeld(EventKeyboard::KeyCode::KEY_CTRL) && isKeyHeld(EventKeyboard::KeyCode::KEY_SHIFT)) {
+            menuCloseCallback(this);
         }
+        break;
+    default:
+        break;
+    }
 
-        // Player control keyh handling
-        if (_activePlayer) {
-            // Select army
-            if (keyCode == gHKSelectArmy) {
-                std::vector<Id> army;
-                for (auto kv : *_objs) {
-                    if (Unit* unit = dynamic_cast<Unit*>(kv.second)) {
-                        if (unit->getPlayer() == _activePlayer) {
-                            army.push_back(unit->getId());
-                        }
+    if (keyCode == gHKTimeWarpFaster) {
+        timeWarpFaster();
+    } else if (keyCode == gHKTimeWarpSlower) {
+        timeWarpSlower();
+    }
+
+    // Player control keyh handling
+    if (_activePlayer) {
+        // Select army
+        if (keyCode == gHKSelectArmy) {
+            std::vector<Id> army;
+            for (Obj* obj : *_objs) {
+                if (Unit* unit = dynamic_cast<Unit*>(obj)) {
+                    if (unit->getPlayer() == _activePlayer) {
+                        army.push_back(unit->getId());
                     }
                 }
-                if (!army.empty()) {
-                    _activePlayer->selected = army;
-                }
             }
+            if (!army.empty()) {
+                _activePlayer->selected = army;
+            }
+        }
 
-            // Group management
-            for (size_t idx = 0; idx < GRP_COUNT; idx++) {
-                if (keyCode == gHKGroup[idx]) {
-                    if (isKeyHeld(EventKeyboard::KeyCode::KEY_CTRL)) {
-                        _activePlayer->setSelectionToGroup(idx);
-                    } else if (isKeyHeld(EventKeyboard::KeyCode::KEY_SHIFT)) {
-                        _activePlayer->addSelectionToGroup(idx);
-                    } else {
-                        _activePlayer->selectGroup(idx);
-                        if (!_keyHistory.empty()) {
-                            const KeyHistory& kh = _keyHistory.back();
-                            // TODO[fate]: add timeout
-                            //auto now = std::chrono::high_resolution_clock::now();
-                            //if (kh.time < now && (now - kh.time).count() <= 1)
-                            if (kh.spec.key == gHKGroup[idx] && kh.spec.mod.empty()) {
-                                playerCenterSelection();
-                            }
+        // Group management
+        for (size_t idx = 0; idx < GRP_COUNT; idx++) {
+            if (keyCode == gHKGroup[idx]) {
+                if (isKeyHeld(EventKeyboard::KeyCode::KEY_CTRL)) {
+                    _activePlayer->setSelectionToGroup(idx);
+                } else if (isKeyHeld(EventKeyboard::KeyCode::KEY_SHIFT)) {
+                    _activePlayer->addSelectionToGroup(idx);
+                } else {
+                    _activePlayer->selectGroup(idx);
+                    if (!_keyHistory.empty()) {
+                        const KeyHistory& kh = _keyHistory.back();
+                        // TODO[fate]: add timeout
+                        //auto now = std::chrono::high_resolution_clock::now();
+                        //if (kh.time < now && (now - kh.time).count() <= 1)
+                        if (kh.spec.key == gHKGroup[idx] && kh.spec.mod.empty()) {
+                            playerCenterSelection();
                         }
                     }
-                    break;
                 }
+                break;
             }
+        }
 
-            // Unit control
-            for (Id id : _activePlayer->selected) {
-                if (auto obj = objs()->getById(id)) {
-                    if (auto tank = dynamic_cast<Tank*>(obj)) {
-                        int repeat = isKeyHeld(EventKeyboard::KeyCode::KEY_SHIFT)? 10: 1;
-                        while (repeat--) {
-                            if (keyCode == gHKShoot) {
-                                tank->shoot();
-                                repeat = 0;
+        // Unit control
+        for (Id id : _activePlayer->selected) {
+            if (auto obj = objs()->getById(id)) {
+                if (auto tank = dynamic_cast<Tank*>(obj)) {
+                    int repeat = isKeyHeld(EventKeyboard::KeyCode::KEY_SHIFT)? 10: 1;
+                    while (repeat--) {
+                        if (keyCode == gHKShoot) {
+                            tank->shoot();
+                            repeat = 0;
 //                            } else if (keyCode == gHKPowerInc) {
 //                                tank->addPower();
 //                            } else if (keyCode == gHKPowerDec) {
@@ -229,16 +466,12 @@ void GameScene::initKeyboard()
 //                                tank->goBack();
 //                            } else if (keyCode == gHKGoFront) {
 //                                tank->goFront();
-                            }
                         }
                     }
                 }
             }
         }
-    };
-    _eventDispatcher->addEventListenerWithSceneGraphPriority(keyboardListener, this);
-//    _eventDispatcher->addEventListenerWithFixedPriority(keyboardListener, 1);
-    createKeyHistoryHandler();
+    }
 }
 
 void GameScene::keyboardUpdate(float delta)
@@ -265,13 +498,15 @@ void GameScene::createKeyHoldHandler()
 {
     auto eventListener = EventListenerKeyboard::create();
     eventListener->onKeyPressed = [=](EventKeyboard::KeyCode keyCode, Event* event) {
-        if (_keyHold.find(keyCode) == _keyHold.end()) {
-            auto now = std::chrono::high_resolution_clock::now();
-            _keyHold[keyCode] = now;
-        }
+        auto now = std::chrono::high_resolution_clock::now();
+        postCommand([=] {
+            if (_keyHold.find(keyCode) == _keyHold.end()) {
+                _keyHold[keyCode] = now;
+            }
+        });
     };
     eventListener->onKeyReleased = [=](EventKeyboard::KeyCode keyCode, Event* event) {
-        _keyHold.erase(keyCode);
+        postCommand([=] { _keyHold.erase(keyCode); });
     };
     this->_eventDispatcher->addEventListenerWithSceneGraphPriority(eventListener, this);
 }
@@ -280,21 +515,23 @@ void GameScene::createKeyHistoryHandler()
 {
     auto eventListener = EventListenerKeyboard::create();
     eventListener->onKeyPressed = [=](EventKeyboard::KeyCode keyCode, Event* event) {
-        if (!KeySpec::isMod(keyCode)) {
-            auto now = std::chrono::high_resolution_clock::now();
-            while (_keyHistory.size() >= _keyHistorySize) {
-                _keyHistory.pop_front();
-            }
-            _keyHistory.push_back(KeyHistory());
-            KeyHistory& kh = _keyHistory.back();
-            kh.time = now;
-            kh.spec.key = keyCode;
-            for (EventKeyboard::KeyCode mod : KeySpec::getKeyModList()) {
-                if (isKeyHeld(mod)) {
-                    kh.spec.mod.insert(mod);
+        auto now = std::chrono::high_resolution_clock::now();
+        postCommand([=] {
+            if (!KeySpec::isMod(keyCode)) {
+                while (_keyHistory.size() >= _keyHistorySize) {
+                    _keyHistory.pop_front();
+                }
+                _keyHistory.push_back(KeyHistory());
+                KeyHistory& kh = _keyHistory.back();
+                kh.time = now;
+                kh.spec.key = keyCode;
+                for (EventKeyboard::KeyCode mod : KeySpec::getKeyModList()) {
+                    if (isKeyHeld(mod)) {
+                        kh.spec.mod.insert(mod);
+                    }
                 }
             }
-        }
+        });
     };
     this->_eventDispatcher->addEventListenerWithSceneGraphPriority(eventListener, this);
 }
@@ -308,10 +545,10 @@ void GameScene::initMouse()
     auto s = Director::getInstance()->getVisibleSize();
     _mouseLastLoc = Vec2(s.width / 2, s.height / 2); // To avoid screen scrolling just after startup
     auto mouseListener = EventListenerMouse::create();
-    mouseListener->onMouseMove = CC_CALLBACK_1(GameScene::onMouseMove, this);
-    mouseListener->onMouseUp = CC_CALLBACK_1(GameScene::onMouseUp, this);
-    mouseListener->onMouseDown = CC_CALLBACK_1(GameScene::onMouseDown, this);
-    mouseListener->onMouseScroll = CC_CALLBACK_1(GameScene::onMouseWheel, this);
+    mouseListener->onMouseMove = [=](Event* event) { postMouseCommand(event, &GameScene::onMouseMove); };
+    mouseListener->onMouseUp = [=](Event* event) { postMouseCommand(event, &GameScene::onMouseUp); };
+    mouseListener->onMouseDown = [=](Event* event) { postMouseCommand(event, &GameScene::onMouseDown); };
+    mouseListener->onMouseScroll = [=](Event* event) { postMouseCommand(event, &GameScene::onMouseWheel); };
     _eventDispatcher->addEventListenerWithFixedPriority(mouseListener, 1);
     this->schedule(schedule_selector(GameScene::onMouseTimer), _mouseTimerIntervalSec);
 
@@ -364,30 +601,17 @@ void GameScene::onMouseUp(Event *event)
                 return Tank::create(game);
             };
             dc->setPlayer(_activePlayer);
-//        } else if (isKeyHeld(EventKeyboard::KeyCode::KEY_V)) {
-//            auto ss = SpaceStation::create(this);
-//            ss->setPosition(pw);
-//            for (auto kv : *_objs) {
-//                if (AstroObj* ao = dynamic_cast<AstroObj*>(kv.second)) {
-//                    PhysicsBody* gsource = ao->getNode()->getPhysicsBody();
-//                    Vec2 p = ss->getNode()->getPhysicsBody()->getPosition();
-//                    Vec2 o = gsource->getPosition();
-//                    Vec2 g = _pworld->getForceField()->getBodyGravity(gsource, p);
-//                    Vec2 r = p - o;
-//                    // For orbital velocity: g = v*v/r  =>  v = sqrt(g*r)
-//                    float v = sqrtf(g.length() * r.length());
-//                    ss->getNode()->getPhysicsBody()->setVelocity(
-//                        v * r.getNormalized().rotate(Vec2::forAngle(M_PI_2))
-//                    );
-//                    break; // TODO[fate]: find nearest planet
-//                }
-//            }
-//            ss->setPlayer(_activePlayer);
+        } else if (isKeyHeld(EventKeyboard::KeyCode::KEY_V)) {
+            auto ss = SpaceStation::create(this);
+            ss->setPosition(pw);
+            ss->getNode()->getPhysicsBody()->setVelocity(_orbits.circularVelocity(pw));
+            ss->setPlayer(_activePlayer);
+            _orbits.enter(ss);
 //        } else if (isKeyHeld(EventKeyboard::KeyCode::KEY_B)) {
 //            auto fact = Factory::create(this);
 //            fact->setPosition(pw);
-//            for (auto kv : *_objs) {
-//                if (Planet* planet = dynamic_cast<Planet*>(kv.second)) {
+//            for (Obj* obj : *_objs) {
+//                if (Planet* planet = dynamic_cast<Planet*>(obj)) {
 //                    auto pb = planet->getNode()->getPhysicsBody();
 
 //                    // Set factory orientation upwards
@@ -533,6 +757,7 @@ float GameScene::viewSelectionRadius(float size)
 void GameScene::initGui()
 {
     _selectionPanel.init(this);
+    _miniMap.init(this, &_view);
 }
 
 void GameScene::guiUpdate(float delta)
@@ -542,8 +767,8 @@ void GameScene::guiUpdate(float delta)
         this->addChild(_guiIndicators, gZOrderIndicators);
     }
     _guiIndicators->clear();
-    for (auto kv : *_objs) {
-        if (Unit* unit = dynamic_cast<Unit*>(kv.second)) {
+    for (Obj* obj : *_objs) {
+        if (Unit* unit = dynamic_cast<Unit*>(obj)) {
             Vec2 pw = unit->getNode()->getPosition();
             float screenSize = rintf(unit->getSize() / _view.getZoom());
             if (screenSize >= 20.0f) {
@@ -575,7 +800,7 @@ void GameScene::guiUpdate(float delta)
                 }
             }
         }
-        if (Building* building = dynamic_cast<Building*>(kv.second)) {
+        if (Building* building = dynamic_cast<Building*>(obj)) {
             Vec2 pw = building->getNode()->getPosition();
             float screenSize = rintf(building->getSize() / _view.getZoom());
             if (screenSize >= 20.0f) {
@@ -658,6 +883,36 @@ void GameScene::guiUpdate(float delta)
         ss << (_activePlayer? _activePlayer->res.amount[i]: 0);
         _resLabels[i]->setString(ss.str());
     }
+
+    // Physics stats
+    if (!_bodiesLabel) {
+        auto s = Director::getInstance()->getVisibleSize();
+        Size size(400, 14);
+        _bodiesLabel = Label::createWithTTF("", "fonts/arial.ttf", size.height, size);
+        _bodiesLabel->setPosition(Vec2(5 + size.width/2, s.height - 15));
+        _bodiesLabel->setHorizontalAlignment(TextHAlignment::LEFT);
+        _bodiesLabel->setVerticalAlignment(TextVAlignment::BOTTOM);
+        this->addChild(_bodiesLabel, gZOrderResLabels);
+    }
+    _bodiesLabel->setVisible(Director::getInstance()->isDisplayStats());
+    if (_bodiesLabel->isVisible()) {
+        size_t awake = 0;
+        size_t sleeping = 0;
+        for (PhysicsBody* body : _pworld->getAllBodies()) {
+            if (body->isDynamic()) {
+                if (body->isResting()) {
+                    sleeping++;
+                } else {
+                    awake++;
+                }
+            }
+        }
+        std::stringstream ss;
+        ss << "Bodies awake: " << awake << " sleeping: " << sleeping;
+        _bodiesLabel->setString(ss.str());
+    }
+
+    _miniMap.update(delta);
 }
 
 void GameScene::initPlayers()
@@ -872,6 +1127,39 @@ void GameScene::onContactSeparate(PhysicsContact& contact)
     dispatchContact(contact, nullptr, nullptr);
 }
 
+bool GameScene::acceptContact(PhysicsContact& contact)
+{
+    // Called from physics thread, so only tags are used here. Rules that depend on game state (e.g. unit
+    // surface) are checked by dispatchContact() on deferred BEGIN, and rejected arbiters are ignored then
+    auto nodeA = contact.getShapeA()->getBody()->getNode();
+    auto nodeB = contact.getShapeB()->getBody()->getNode();
+    if (!nodeA || !nodeB) {
+        return false;
+    }
+    ObjType typeA = ObjTag(nodeA->getTag()).type();
+    ObjType typeB = ObjTag(nodeB->getTag()).type();
+    ShapeTag shapeA(contact.getShapeA()->getTag());
+    ShapeTag shapeB(contact.getShapeB()->getTag());
+    auto is = [=] (ObjType x, ObjType y) {
+        return (typeA == x && typeB == y) || (typeA == y && typeB == x);
+    };
+    if (is(ObjType::Unit, ObjType::Unit) || is(ObjType::Projectile, ObjType::Projectile)) {
+        return false;
+    }
+    if (is(ObjType::Unit, ObjType::AstroObj)) {
+        // Building platforms are only for buildings
+        ShapeTag aobjShape = (typeA == ObjType::AstroObj? shapeA: shapeB);
+        return !aobjShape.is(AstroObj::ShapeType::BuildingPlatform);
+    }
+    if (is(ObjType::Projectile, ObjType::AstroObj) || is(ObjType::Projectile, ObjType::Unit)) {
+        return false; // Projectile is destroyed on any hit
+    }
+    if (is(ObjType::Building, ObjType::Unit) || is(ObjType::Building, ObjType::Projectile)) {
+        return false;
+    }
+    return true;
+}
+
 bool GameScene::dispatchContact(PhysicsContact& contact,
                                 PhysicsContactPreSolve* preSolve,
                                 const PhysicsContactPostSolve* postSolve)
@@ -1028,7 +1316,12 @@ void GameScene::updateUnitVelocityOnSurface(cpBody* body, float dt)
             // TODO[fate]: calculate normal force using astroobj's gravity and apply
             // force of friction (rolling resistance) instead of this:
             float w_surf = surface->getNode()->getPhysicsBody()->getAngularVelocity();
-            body->w -= (body->w - w_surf) * (1 - cpfpow(0.1, dt));
+            float dw = body->w - w_surf;
+            if (fabsf(dw) < gIdleAngularVelocity) {
+                body->w = w_surf; // Do not keep resting unit awake with infinite damping
+            } else {
+                body->w -= dw * (1 - cpfpow(0.1, dt));
+            }
         } else {
             // surface aobj was destroyed
             unit->surfaceId = 0;
@@ -1037,6 +1330,51 @@ void GameScene::updateUnitVelocityOnSurface(cpBody* body, float dt)
     }
 }
 
+OrderGroup* GameScene::createOrderGroup()
+{
+    _orderGroups.emplace_back(new OrderGroup(this));
+    return _orderGroups.back().get();
+}
+
+void GameScene::orderGroupsUpdate(float delta)
+{
+    for (auto& group : _orderGroups) {
+        group->update(delta);
+    }
+    _orderGroups.erase(std::remove_if(_orderGroups.begin(), _orderGroups.end(), [] (const std::unique_ptr<OrderGroup>& group) {
+        return group->empty();
+    }), _orderGroups.end());
+}
+
+const std::vector<Vec2>& GameScene::surfaceUnitPositions(Planet* planet)
+{
+    return _surfaceUnits[planet->getId()];
+}
+
+std::shared_ptr<const FlowField> GameScene::getFlowField(Planet* planet, Vec2 dst)
+{
+    float a = planet->world2polar(dst).a;
+    FlowFieldKey key(planet->getId(), planet->segments().locate(a) - planet->segments().begin());
+
+    // Forget outdated fields, units that already have them keep using them
+    for (auto i = _flowFields.begin(), e = _flowFields.end(); i != e;) {
+        if (i->second.field.expired() || _time - i->second.created > gFlowFieldTtl) {
+            _flowFields.erase(i++);
+        } else {
+            ++i;
+        }
+    }
+
+    FlowFieldEntry& entry = _flowFields[key];
+    if (auto field = entry.field.lock()) {
+        return field;
+    }
+    auto field = std::make_shared<const FlowField>(this, planet, a);
+    entry.field = field;
+    entry.created = _time;
+    return field;
+}
+
 float GameScene::initBuildings(Planet* planet, Player** players, size_t playersCount)
 {
     auto pb = planet->getNode()->getPhysicsBody();
@@ -1119,11 +1457,17 @@ float GameScene::initBuildings(Planet* planet, Player** players, size_t playersC
     return planet->world2polar(humanFact->getNode()->getPosition()).getLongitude();
 }
 
-void GameScene::initGalaxy()
+void GameScene::initGalaxy(GalaxyDesc& galaxy)
 {
-    auto pl = Planet::create(this);
-    _planet = pl;
-    pl->setPosition(Vec2::ZERO);
+    CCASSERT(!galaxy.planets.empty(), "galaxy without home planet");
+    for (PlanetDesc& desc : galaxy.planets) {
+        auto planet = Planet::create(this, std::move(desc));
+        _planets.push_back(planet);
+        if (!_planet) {
+            _planet = planet;
+        }
+    }
+    auto pl = _planet;
     //pl->getNode()->getPhysicsBody()->applyTorque(1e11);
     //pl->getNode()->getPhysicsBody()->applyImpulse(Vec2(1e11,0.5e11));
 
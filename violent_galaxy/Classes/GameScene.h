@@ -2,40 +2,82 @@
 
 #include "Defs.h"
 #include "base/CCRefPtr.h"
+#include "FlowField.h"
+#include "SpriteAtlas.h"
 #include "Units.h"
 #include "AstroObjs.h"
 #include "Player.h"
 #include "WorldView.h"
+#include "MiniMap.h"
+#include "Effects.h"
+#include "Ballistics.h"
+#include "Blasts.h"
+#include "Visibility.h"
+#include "FogOfWar.h"
+#include "Orbits.h"
+#include "Galaxy.h"
+#include "TerrainDetail.h"
 
+class Building;
+
+// Slot array of objects addressed by generational handles
+// Lookup by id is O(1) and returns nullptr for handles of destroyed objects
 template <class Id, class T>
 class Storage : public cc::Ref {
+private:
+    struct Slot {
+        T* t = nullptr;
+        ui32 generation = 1; // Zero generation is never used, so zero id is always invalid
+        size_t pos = 0; // Position in _live
+    };
 public:
-    using Map = cc::Map<Id, T*>;
-    using iterator = typename Map::iterator;
-    using const_iterator = typename Map::const_iterator;
+    // Iterates over live objects, objects added during iteration are also visited
+    class iterator {
+    public:
+        iterator(Storage* storage, size_t pos) : _storage(storage), _pos(pos) { skip(); }
+        T* operator*() const { return _storage->_live[_pos]; }
+        iterator& operator++() { ++_pos; skip(); return *this; }
+        bool operator!=(const iterator& o) const { return _pos < _storage->_live.size() || o._pos < _storage->_live.size(); }
+    private:
+        void skip() { while (_pos < _storage->_live.size() && !_storage->_live[_pos]) ++_pos; }
+        Storage* _storage;
+        size_t _pos;
+    };
 public:
-    iterator begin() { return _map.begin(); }
-    iterator end() { return _map.end(); }
-    const_iterator begin() const { return _map.begin(); }
-    const_iterator end() const { return _map.end(); }
-    const_iterator cbegin() const { return _map.cbegin(); }
-    const_iterator cend() const { return _map.cend(); }
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, std::numeric_limits<size_t>::max()); }
 
     void add(T* t)
     {
-        t->setId(++_lastId);
-        CCASSERT(_map.find(t->getId()) == _map.end(), "storage id duplicate");
-        _map.insert(t->getId(), t);
+        ui32 index;
+        if (_free.size() > _freeReserve) {
+            // FIFO recycling to make generation wrap-around as rare as possible
+            index = _free.front();
+            _free.pop_front();
+        } else {
+            index = _slots.size();
+            CCASSERT(index <= IdIndexMask, "storage overflow");
+            _slots.emplace_back();
+        }
+        Slot& slot = _slots[index];
+        slot.t = t;
+        slot.pos = _live.size();
+        _live.push_back(t);
+        t->retain();
+        t->setId(makeId(index, slot.generation));
     }
 
     T* getById(Id id)
     {
-        auto iter = _map.find(id);
-        if (iter == _map.end()) {
+        ui32 index = idIndex(id);
+        if (index >= _slots.size()) {
             return nullptr;
         }
-        T* unit = iter->second;
-        return unit;
+        const Slot& slot = _slots[index];
+        if (slot.generation != idGeneration(id)) {
+            return nullptr; // Stale handle
+        }
+        return slot.t;
     }
 
     template <class U>
@@ -46,24 +88,21 @@ public:
 
     T* releaseById(Id id)
     {
-        auto iter = _map.find(id);
-        if (iter == _map.end()) {
+        T* t = getById(id);
+        if (!t) {
             return nullptr;
         }
-        T* t = iter->second;
         t->retain();
-        _map.erase(iter);
+        erase(id);
         t->autorelease();
         return t;
     }
 
     void remove(T* t)
     {
-        auto iter = _map.find(t->getId());
-        if (iter == _map.end()) {
-            return;
+        if (getById(t->getId()) == t) {
+            erase(t->getId());
         }
-        _map.erase(iter);
     }
 
     void release(T* t)
@@ -71,13 +110,49 @@ public:
         releaseById(t->getId());
     }
 
+    // Removes holes left by removed objects, must not be called during iteration
+    void compact()
+    {
+        if (_holes == 0) {
+            return;
+        }
+        size_t pos = 0;
+        for (T* t : _live) {
+            if (t) {
+                _slots[idIndex(t->getId())].pos = pos;
+                _live[pos++] = t;
+            }
+        }
+        _live.resize(pos);
+        _holes = 0;
+    }
+
     CREATE_FUNC(Storage);
 private:
     Storage() {}
     bool init() { return true; }
+
+    void erase(Id id)
+    {
+        ui32 index = idIndex(id);
+        Slot& slot = _slots[index];
+        T* t = slot.t;
+        _live[slot.pos] = nullptr; // Keep positions of other objects valid during iteration
+        _holes++;
+        slot.t = nullptr;
+        slot.generation = (slot.generation + 1) & IdGenerationMask;
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+        _free.push_back(index);
+        t->release();
+    }
 private:
-    Id _lastId = 0;
-    Map _map;
+    static constexpr size_t _freeReserve = 1024; // Free slots that are not reused to delay generation wrap-around
+    std::vector<Slot> _slots;
+    std::deque<ui32> _free;
+    std::vector<T*> _live;
+    size_t _holes = 0;
 };
 
 using ObjStorage = Storage<Id, Obj>;
@@ -104,28 +179,82 @@ private:
 class GameScene : public cc::Layer
 {
 public:
-    static cc::Scene* createScene();
+    static cc::Scene* createScene(GalaxyDesc&& galaxy);
     CREATE_FUNC(GameScene);
 
     ObjStorage* objs() { return _objs.get(); }
+    const std::vector<Planet*>& planets() const { return _planets; }
+    SpriteAtlas* atlas() { return &_atlas; }
+    DebrisSystem* debris() { return _debris; }
+    Ballistics* ballistics() { return &_ballistics; }
+    Blasts* blasts() { return &_blasts; }
+    Visibility* visibility() { return &_visibility; }
+    FogOfWar* fogOfWar() { return &_fogOfWar; }
+    Player* activePlayer() { return _activePlayer; }
+    OrbitSystem* orbits() { return &_orbits; }
+    TerrainDetail* terrain() { return &_terrain; }
+    TileGrid<Unit*>& unitGrid() { return _unitGrid; }
+    const std::vector<cc::Vec2>& surfaceUnitPositions(Planet* planet); // Units in contact with planet, updated every frame
     void addDeadObj(Obj* obj);
     cc::PhysicsWorld* physicsWorld() { return _pworld; }
 public:
     void menuCloseCallback(cc::Ref* pSender);
 private: // Scene
     GameScene()
-        : _unitGrid(3200, 5)
+        : _unitGrid(6400, 5)
+        , _lodGrid(65536, 4)
     {}
     virtual bool init() override;
     void update(float delta) override;
 private: // World
-    void createWorld(cc::Scene* scene, cc::PhysicsWorld* pworld);
+    void createWorld(cc::Scene* scene, cc::PhysicsWorld* pworld, GalaxyDesc& galaxy);
     cc::PhysicsWorld* _pworld = nullptr;
     cc::RefPtr<ObjStorage> _objs;
     std::set<Obj*> _deadObjs;
     TileGrid<Unit*> _unitGrid;
+    std::unordered_map<Id, std::vector<cc::Vec2>> _surfaceUnits; // Planet id -> positions of units on its surface
+    SpriteAtlas _atlas;
+    DebrisSystem* _debris = nullptr;
+    Ballistics _ballistics;
+    Blasts _blasts;
+    Visibility _visibility;
+    FogOfWar _fogOfWar;
+    OrbitSystem _orbits;
+    TerrainDetail _terrain;
+    void cullUpdate();
+    void captureUpdate(float delta);
+    // Buffers of batch query for all buildings checking capture
+    std::vector<Building*> _captureBuildings;
+    std::vector<cc::Vec2> _capturePoints;
+    std::vector<float> _captureDistances;
+    std::vector<int> _captureMasks;
+    std::vector<int> _captureOffsets;
+    std::vector<cc::PhysicsShape*> _captureShapes;
+private: // Simulation LOD
+    void lodUpdate(float delta);
+    TileGrid<Unit*> _lodGrid;
+    float _lodElapsed = 0.0f;
+public: // Time warp
+    void timeWarpFaster();
+    void timeWarpSlower();
+private:
+    void timeWarpSet(size_t level);
+    void timeWarpUpdate(float delta);
+    size_t _timeWarpLevel = 0; // Index in gTimeWarpLevels or WARP_COUNT for max warp
+    float _timeWarpSpeed = 1.0f;
+    float _normalAnimationInterval = 0.0f;
+    cc::Label* _timeWarpLabel = nullptr;
+public: // Commands
+    // Input is not handled right away, but is executed as command at the beginning of next update,
+    // when the simulation is not running on physics thread
+    using Command = std::function<void()>;
+    void postCommand(const Command& command);
+private:
+    void commandsUpdate();
+    std::vector<Command> _commands;
 private: // Keyboard
     void initKeyboard();
+    void onKeyPressed(cc::EventKeyboard::KeyCode keyCode);
     void keyboardUpdate(float delta);
     void createKeyHoldHandler();
     void createKeyHistoryHandler();
@@ -135,6 +264,7 @@ private: // Keyboard
     static constexpr size_t _keyHistorySize = 10;
 private: // Mouse
     void initMouse();
+    void postMouseCommand(cc::Event* event, void (GameScene::*handler)(cc::Event*));
     void onMouseMove(cc::Event *event);
     void onMouseDown(cc::Event *event);
     void onMouseUp(cc::Event *event);
@@ -168,7 +298,9 @@ private: // GUI
     cc::DrawNode* _resIcons = nullptr;
     cc::Label* _supplyLabel = nullptr;
     cc::Label* _resLabels[RES_COUNT] = {0};
+    cc::Label* _bodiesLabel = nullptr;
     Panels _selectionPanel;
+    MiniMap _miniMap;
 private: // Players
     void initPlayers();
     void playerUpdate(float delta);
@@ -187,6 +319,7 @@ private:
     Players _players;
 public: // Collisions
     void initCollisions();
+    bool acceptContact(cc::PhysicsContact& contact);
     bool onContactBegin(cc::PhysicsContact& contact);
     bool onContactPreSolve(cc::PhysicsContact& contact, cc::PhysicsContactPreSolve& solve);
     void onContactPostSolve(cc::PhysicsContact& contact, const cc::PhysicsContactPostSolve& solve);
@@ -199,8 +332,24 @@ private:
     bool onContactProjectileAstroObj(ContactInfo& cinfo);
     bool onContactProjectileUnit(ContactInfo& cinfo);
     void updateUnitVelocityOnSurface(cpBody* body, float dt);
+public: // Pathing
+    std::shared_ptr<const FlowField> getFlowField(Planet* planet, cc::Vec2 dst);
+private:
+    struct FlowFieldEntry {
+        std::weak_ptr<const FlowField> field;
+        float created;
+    };
+    using FlowFieldKey = std::pair<Id, size_t>; // planet id and destination segment idx
+    std::map<FlowFieldKey, FlowFieldEntry> _flowFields;
+    float _time = 0.0f;
+public: // Orders
+    OrderGroup* createOrderGroup();
+private:
+    void orderGroupsUpdate(float delta);
+    std::vector<std::unique_ptr<OrderGroup>> _orderGroups;
 public: // Galaxy
-    void initGalaxy();
+    void initGalaxy(GalaxyDesc& galaxy);
     float initBuildings(Planet* planet, Player** players, size_t playersCount);
     Planet* _planet = nullptr;
+    std::vector<Planet*> _planets; // Planets are never destroyed, so list is filled once
 };
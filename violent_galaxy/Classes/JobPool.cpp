@@ -0,0 +1,78 @@
+#include "JobPool.h"
+
+JobPool::JobPool(size_t threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _threads.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        _threads.emplace_back(&JobPool::run, this);
+    }
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _jobAdded.notify_all();
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+void JobPool::submit(Job&& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+        _pending++;
+    }
+    _jobAdded.notify_one();
+}
+
+void JobPool::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobDone.wait(lock, [this] { return _pending == 0; });
+}
+
+void JobPool::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending -= _jobs.size();
+        _jobs.clear();
+    }
+    _jobDone.notify_all();
+}
+
+size_t JobPool::pending()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending;
+}
+
+void JobPool::run()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobAdded.wait(lock, [this] { return _stop || !_jobs.empty(); });
+            if (_jobs.empty()) {
+                return; // Stopped and nothing left to do
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending--;
+        }
+        _jobDone.notify_all();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Defs.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads executing submitted jobs in order of submission.
+// Jobs must not touch scene graph or physics world, they are meant for pure computations
+// whose results are taken by main thread after wait() or when pending() drops to zero
+class JobPool {
+public:
+    using Job = std::function<void()>;
+
+    explicit JobPool(size_t threads = 0); // Zero is for one thread per hardware core
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    void submit(Job&& job);
+    void wait(); // Blocks until all submitted jobs are done
+    void cancel(); // Drops jobs that are not started yet, running ones are still to be waited for
+    size_t pending(); // Jobs submitted but not done yet
+    size_t threads() const { return _threads.size(); }
+private:
+    void run();
+private:
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _jobAdded;
+    std::condition_variable _jobDone;
+    std::deque<Job> _jobs;
+    size_t _pending = 0;
+    bool _stop = false;
+};
@@ -0,0 +1,50 @@
+#include "LoadingScene.h"
+#include "GameScene.h"
+
+#include <random>
+
+USING_NS_CC;
+
+Scene* LoadingScene::createScene()
+{
+    auto scene = Scene::create();
+    scene->addChild(LoadingScene::create());
+    return scene;
+}
+
+bool LoadingScene::init()
+{
+    if (!Layer::init()) {
+        return false;
+    }
+
+    auto s = Director::getInstance()->getVisibleSize();
+    Vec2 o = Director::getInstance()->getVisibleOrigin();
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 24);
+    _label->setPosition(o + Vec2(s.width / 2, s.height / 2));
+    addChild(_label);
+
+    ui64 seed = gGalaxySeed;
+    if (seed == 0) {
+        std::random_device rd;
+        seed = (ui64(rd()) << 32) | rd();
+    }
+    _generator.reset(new GalaxyGenerator());
+    _generator->start(seed, gGalaxySystems);
+    scheduleUpdate();
+    return true;
+}
+
+void LoadingScene::update(float delta)
+{
+    if (_done) {
+        return;
+    }
+    char text[64];
+    snprintf(text, sizeof(text), "Generating galaxy... %d%%", int(_generator->getProgress() * 100));
+    _label->setString(text);
+    if (_generator->isDone()) {
+        _done = true; // Scene is replaced at the beginning of the next frame
+        Director::getInstance()->replaceScene(GameScene::createScene(_generator->take()));
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Defs.h"
+#include "Galaxy.h"
+
+#include <memory>
+
+// Shown while galaxy is generated off the main thread, then replaced with game scene
+class LoadingScene : public cc::Layer
+{
+public:
+    static cc::Scene* createScene();
+    CREATE_FUNC(LoadingScene);
+private:
+    LoadingScene() {}
+    virtual bool init() override;
+    void update(float delta) override;
+private:
+    std::unique_ptr<GalaxyGenerator> _generator;
+    cc::Label* _label = nullptr;
+    bool _done = false;
+};
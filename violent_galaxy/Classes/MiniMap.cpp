@@ -0,0 +1,143 @@
+#include "MiniMap.h"
+#include "GameScene.h"
+#include "Buildings.h"
+
+USING_NS_CC;
+
+void MiniMap::init(GameScene* game, WorldView* view)
+{
+    _game = game;
+    _view = view;
+    _origin = Vec2::ZERO;
+    _size = Size(gMiniMapPanelWidth, gMiniMapPanelHeight);
+
+    _background = DrawNode::create();
+    _background->drawSolidRect(_origin, _origin + Vec2(_size), gPanelBgColor);
+    _game->addChild(_background, gZOrderMiniMap);
+
+    auto clip = ClippingRectangleNode::create(Rect(_origin, _size));
+    _background->addChild(clip);
+
+    _terrain = RenderTexture::create(_size.width, _size.height, Texture2D::PixelFormat::RGBA8888);
+    _terrain->setPosition(_origin + Vec2(_size) / 2);
+    clip->addChild(_terrain, 0);
+    focus(planetUnderView());
+
+    _markers = DrawNode::create();
+    clip->addChild(_markers, 1);
+
+    _viewport = DrawNode::create();
+    clip->addChild(_viewport, 2);
+
+    auto border = DrawNode::create();
+    border->drawRect(_origin, _origin + Vec2(_size), gPanelBorderColor);
+    _background->addChild(border, 1);
+
+    updateMarkers();
+    updateViewport();
+}
+
+void MiniMap::update(float delta)
+{
+    _markersElapsed += delta;
+    if (_markersElapsed >= gMiniMapUpdateInterval) {
+        _markersElapsed = 0.0f;
+        Planet* planet = planetUnderView();
+        if (planet && planet->getId() != _focusId) {
+            focus(planet);
+        }
+        updateMarkers();
+    }
+    updateViewport();
+}
+
+// Planet with the nearest space around view center
+Planet* MiniMap::planetUnderView()
+{
+    Vec2 center = _view->getCenter();
+    Planet* ret = nullptr;
+    float minDist = 0.0f;
+    for (Planet* planet : _game->planets()) {
+        float dist = planet->getNode()->getPosition().distance(center) - planet->getSpaceRadius();
+        if (!ret || dist < minDist) {
+            ret = planet;
+            minDist = dist;
+        }
+    }
+    return ret;
+}
+
+void MiniMap::focus(Planet* planet)
+{
+    _focusId = planet->getId();
+    _center = planet->getNode()->getPosition();
+    float extent = 2 * planet->getSpaceRadius() * gMiniMapRange;
+    _scale = std::min(_size.width, _size.height) / extent;
+    renderTerrain();
+}
+
+void MiniMap::renderTerrain()
+{
+    // Planets do not change their shape, so silhouettes are rendered once per focus
+    Color4F crustColor(0.5f, 0.4f, 0.0f, 1.0f);
+    float mapRadius = Vec2(_size).length() / 2 / _scale;
+    _silhouette = DrawNode::create();
+    for (Planet* planet : _game->planets()) {
+        if (planet->getNode()->getPosition().distance(_center) < mapRadius + planet->getSpaceRadius()) {
+            Vec2 center = world2map(planet->getNode()->getPosition()) - _origin;
+            Vec2 vert[3];
+            vert[2] = center;
+            Vec2 c1 = world2map(planet->getNode()->convertToWorldSpace(planet->crust().back())) - _origin;
+            for (Vec2 pl : planet->crust()) {
+                Vec2 c2 = world2map(planet->getNode()->convertToWorldSpace(pl)) - _origin;
+                vert[0] = c1;
+                vert[1] = c2;
+                _silhouette->drawSolidPoly(vert, 3, crustColor);
+                c1 = c2;
+            }
+        }
+    }
+    _terrain->beginWithClear(0.0f, 0.0f, 0.0f, 0.0f);
+    _silhouette->visit();
+    _terrain->end();
+}
+
+void MiniMap::updateMarkers()
+{
+    _markers->clear();
+    for (Obj* obj : *_game->objs()) {
+        VisualObj* vobj = nullptr;
+        if (Unit* unit = dynamic_cast<Unit*>(obj)) {
+            vobj = unit;
+        } else if (Building* building = dynamic_cast<Building*>(obj)) {
+            vobj = building;
+        }
+        if (vobj && !vobj->isFogHidden()) {
+            Player* player = vobj->getPlayer();
+            Color4F color = (player? player->color: gNeutralPlayerColor);
+            _markers->drawPoint(world2map(vobj->getNode()->getPosition()), gMiniMapMarkerSize, color);
+        }
+    }
+}
+
+void MiniMap::updateViewport()
+{
+    Size s = Director::getInstance()->getVisibleSize();
+    Vec2 corners[4] = {
+        world2map(_view->screen2world(Vec2(0, 0))),
+        world2map(_view->screen2world(Vec2(s.width, 0))),
+        world2map(_view->screen2world(Vec2(s.width, s.height))),
+        world2map(_view->screen2world(Vec2(0, s.height)))
+    };
+    if (std::equal(corners, corners + 4, _viewportCorners)) {
+        return; // View has not changed
+    }
+    std::copy(corners, corners + 4, _viewportCorners);
+    _viewport->clear();
+    _viewport->drawPoly(corners, 4, true, Color4F::WHITE);
+}
+
+Vec2 MiniMap::world2map(Vec2 w) const
+{
+    return _origin + Vec2(_size) / 2 + (w - _center) * _scale;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Defs.h"
+#include "base/CCRefPtr.h"
+
+class GameScene;
+class WorldView;
+class Planet;
+
+// Map of space around planet under view in bottom left panel, the whole galaxy is too large to
+// show units on it. Terrain is rendered into texture only when map switches to another planet,
+// markers of units and buildings are redrawn at low rate as a single list of points
+class MiniMap {
+public:
+    void init(GameScene* game, WorldView* view);
+    void update(float delta);
+private:
+    Planet* planetUnderView();
+    void focus(Planet* planet);
+    void renderTerrain();
+    void updateMarkers();
+    void updateViewport();
+    cc::Vec2 world2map(cc::Vec2 w) const;
+private:
+    GameScene* _game = nullptr;
+    WorldView* _view = nullptr;
+    cc::Vec2 _origin; // Screen position of panel left bottom corner
+    cc::Size _size;
+    Id _focusId = 0; // Planet in the middle of map
+    cc::Vec2 _center; // World point in the middle of map
+    float _scale = 1.0f; // Map length per world length
+    cc::DrawNode* _background = nullptr;
+    cc::RenderTexture* _terrain = nullptr;
+    cc::RefPtr<cc::DrawNode> _silhouette; // Kept alive until terrain is rendered
+    cc::DrawNode* _markers = nullptr;
+    cc::DrawNode* _viewport = nullptr;
+    cc::Vec2 _viewportCorners[4];
+    float _markersElapsed = 0.0f;
+};
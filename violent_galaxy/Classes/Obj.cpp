@@ -47,6 +47,9 @@ bool VisualObj::init(GameScene* game)
     if (auto body = createBody()) {
         _rootNode->setPhysicsBody(body);
     }
+    if (isFoggable()) {
+        game->fogOfWar()->addTarget(this);
+    }
 
     // draw() is not called because you should call setZs() anyway
     return true;
@@ -54,6 +57,8 @@ bool VisualObj::init(GameScene* game)
 
 void VisualObj::destroy()
 {
+    _game->visibility()->removeObserver(_id);
+    _game->fogOfWar()->removeTarget(_id);
     _rootNode->removeFromParent();
     Obj::destroy();
 }
@@ -66,8 +71,17 @@ void VisualObj::setPosition(const Vec2& position)
     }
 }
 
+void VisualObj::cull(const WorldView& view)
+{
+    // Size is used as radius to cover parts sticking out of physical shape (e.g. chimneys)
+    _rootNode->setVisible(!_fogHidden && view.isVisible(_rootNode->getPosition(), getSize()));
+}
+
 void VisualObj::setZs(Zs zs)
 {
+    if (_zs == zs) {
+        return; // Nothing to redraw
+    }
     _zs = zs;
     if (_useZsForLocalZOrder) {
         _rootNode->setLocalZOrder(ZsOrder(_zs));
@@ -82,7 +96,11 @@ void VisualObj::setZs(Zs zs)
 
 void VisualObj::setPlayer(Player* player)
 {
+    if (_player == player) {
+        return; // Nothing to redraw
+    }
     _player = player;
+    _game->visibility()->addObserver(this);
     draw();
 }
 
@@ -111,3 +129,44 @@ Color4F VisualObj::uniformColor()
     return colorFilter(Color4F::BLACK, 1.0f);
 }
 
+Sprite* VisualObj::drawCached(DrawNode* node, int part, const std::string& key,
+                              const Rect& bounds, const SpriteAtlas::DrawFunc& func)
+{
+    SpriteFrame* frame = nullptr;
+    if (gSpriteAtlasEnabled) {
+        frame = _game->atlas()->getFrame(key, bounds, func);
+    }
+    int tag = SpriteAtlas::spriteTag + part;
+    Sprite* sprite = static_cast<Sprite*>(node->getChildByTag(tag));
+    if (!frame) {
+        if (sprite) {
+            sprite->removeFromParent();
+        }
+        func(node); // Fallback to direct drawing
+        return nullptr;
+    }
+
+    if (!sprite) {
+        sprite = Sprite::create();
+        sprite->setTag(tag);
+        sprite->setScale(1.0f / gSpriteAtlasScale);
+        sprite->setCameraMask(node->getCameraMask());
+        node->addChild(sprite);
+    }
+    if (!sprite->isFrameDisplayed(frame)) {
+        sprite->setSpriteFrame(frame);
+        sprite->setBlendFunc(BlendFunc::ALPHA_PREMULTIPLIED); // Atlas is rendered by draw nodes
+        Size size = frame->getRect().size;
+        sprite->setAnchorPoint(Vec2(
+            -bounds.getMinX() * gSpriteAtlasScale / size.width,
+            -bounds.getMinY() * gSpriteAtlasScale / size.height
+        ));
+    }
+    return sprite;
+}
+
+std::string VisualObj::atlasKey()
+{
+    return std::string(typeid(*this).name()) + "#" + SpriteAtlas::colorKey(uniformColor());
+}
+
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Defs.h"
+#include "SpriteAtlas.h"
+
+class WorldView;
 
 #define OBJ_CREATE_FUNC(type) \
     static type* create(GameScene* game) \
@@ -39,7 +42,7 @@ public:
     ObjTag(ObjType type, ui32 id)
     {
         CCASSERT((id & ~idMask) == 0, "id overflow");
-        _value = ((ui8)type << typeShift) | id;
+        _value = ((ui32)(ui8)type << typeShift) | id;
     }
 
     ObjType type() const
@@ -64,9 +67,9 @@ public:
 private:
     ui32 _value;
 
-    static constexpr ui32 idMask = 0xffffff; // 24 bits
-    static constexpr ui32 typeMask = 0xf000000; // 4 bits
-    static constexpr ui32 typeShift = 24;
+    static constexpr ui32 idMask = 0xfffffff; // 28 bits
+    static constexpr ui32 typeMask = 0xf0000000; // 4 bits
+    static constexpr ui32 typeShift = 28;
 };
 
 class Obj : public cc::Ref {
@@ -93,8 +96,13 @@ public:
     void setZs(Zs zs);
     Zs getZs(Zs zs) const { return _zs; }
     virtual float getSize() = 0;
+    virtual float getSightRadius() { return 0.0f; } // Objects of players see around, see Visibility
+    virtual bool isFoggable() { return false; } // Hidden if not seen by active player, see FogOfWar
     virtual void setPlayer(Player* player);
     Player* getPlayer() { return _player; }
+    virtual void cull(const WorldView& view); // Hides nodes that are out of view
+    void setFogHidden(bool hidden) { _fogHidden = hidden; } // Hides nodes of enemy in fog of war regardless of view
+    bool isFogHidden() const { return _fogHidden; }
 protected:
     VisualObj() {}
     bool init(GameScene* game) override;
@@ -104,9 +112,16 @@ protected:
     virtual void draw() = 0;
     cc::Color4F colorFilter(cc::Color4F c, float uniform = 0.0f);
     cc::Color4F uniformColor();
+
+    // Draws image by func into node or, in sprite atlas mode, shows it as sprite child of node
+    // Part distinguishes different sprites of one node. Returns sprite or nullptr if none is used
+    cc::Sprite* drawCached(cc::DrawNode* node, int part, const std::string& key,
+                           const cc::Rect& bounds, const SpriteAtlas::DrawFunc& func);
+    std::string atlasKey(); // Key of image that depends only on object type and uniform color
 protected:
     cc::Node* _rootNode = nullptr;
     Zs _zs = ZsNone;
     bool _useZsForLocalZOrder = true;
     Player* _player = nullptr;
+    bool _fogHidden = false;
 };
@@ -0,0 +1,216 @@
+#include "Orbits.h"
+#include "GameScene.h"
+
+USING_NS_CC;
+
+bool Orbit::init(Id centerId_, double mu_, Vec2 r, Vec2 v, double t)
+{
+    double rlen = sqrt(double(r.x) * r.x + double(r.y) * r.y);
+    double v2 = double(v.x) * v.x + double(v.y) * v.y;
+    double h = double(r.x) * v.y - double(r.y) * v.x; // Specific angular momentum
+    double energy = v2 / 2 - mu_ / rlen;
+    if (rlen == 0.0 || h == 0.0 || energy >= 0.0) {
+        return false; // Radial fall or escape
+    }
+
+    // Eccentricity vector points to periapsis
+    double rv = double(r.x) * v.x + double(r.y) * v.y;
+    double ex = ((v2 - mu_ / rlen) * r.x - rv * v.x) / mu_;
+    double ey = ((v2 - mu_ / rlen) * r.y - rv * v.y) / mu_;
+
+    centerId = centerId_;
+    mu = mu_;
+    a = -mu / (2 * energy);
+    e = sqrt(ex * ex + ey * ey);
+    dir = (h > 0.0? 1.0: -1.0);
+    w = (e > 1e-9? atan2(ey, ex): atan2(r.y, r.x)); // Periapsis of circular orbit is arbitrary
+
+    double nu = dir * (atan2(r.y, r.x) - w); // True anomaly
+    double E = 2 * atan2(sqrt(1 - e) * sin(nu / 2), sqrt(1 + e) * cos(nu / 2)); // Eccentric anomaly
+    m0 = E - e * sin(E);
+    t0 = t;
+    return true;
+}
+
+void Orbit::stateAt(double t, Vec2& r, Vec2& v) const
+{
+    // Solve Kepler's equation M = E - e*sin(E) by Newton's method
+    double n = sqrt(mu / (a * a * a));
+    double M = fmod(m0 + n * (t - t0), 2 * M_PI);
+    double E = (e < 0.8? M: M_PI);
+    for (int i = 0; i < 16; i++) {
+        double dE = (E - e * sin(E) - M) / (1 - e * cos(E));
+        E -= dE;
+        if (fabs(dE) < 1e-12) {
+            break;
+        }
+    }
+
+    // State in frame with Ox toward periapsis, mirrored for clockwise motion
+    double cosE = cos(E);
+    double sinE = sin(E);
+    double q = sqrt(1 - e * e);
+    double rlen = a * (1 - e * cosE);
+    double k = sqrt(mu * a) / rlen;
+    double px = a * (cosE - e);
+    double py = dir * a * q * sinE;
+    double vx = -k * sinE;
+    double vy = dir * k * q * cosE;
+
+    double cosW = cos(w);
+    double sinW = sin(w);
+    r.set(px * cosW - py * sinW, px * sinW + py * cosW);
+    v.set(vx * cosW - vy * sinW, vx * sinW + vy * cosW);
+}
+
+void OrbitSystem::init(GameScene* game)
+{
+    _game = game;
+}
+
+void OrbitSystem::update(float delta)
+{
+    _time += delta;
+    PhysicsForceField* ffield = _game->physicsWorld()->getForceField();
+    for (Entry& entry : _entries) {
+        VisualObj* obj = _game->objs()->getByIdAs<VisualObj>(entry.objId);
+        if (!obj) {
+            entry.objId = 0;
+            continue;
+        }
+        PhysicsBody* body = obj->getNode()->getPhysicsBody();
+        AstroObj* center = _game->objs()->getByIdAs<AstroObj>(entry.orbit.centerId);
+        if (!center) {
+            leave(entry, obj, body->getVelocity());
+            continue;
+        }
+
+        Vec2 r;
+        Vec2 v;
+        entry.orbit.stateAt(_time, r, v);
+        PhysicsBody* centerBody = center->getNode()->getPhysicsBody();
+        Vec2 p = centerBody->getPosition() + r;
+        v += centerBody->getVelocity();
+
+        // Orbit is valid only while gravity of other sources is negligible
+        float rlen = r.length();
+        Vec2 g = ffield->getGravity(p);
+        Vec2 gc = r * float(-entry.orbit.mu / (double(rlen) * rlen * rlen));
+        if (rlen < entryRadius(center) || g.distance(gc) > gOrbitMaxPerturbation * gc.length()) {
+            leave(entry, obj, v);
+            continue;
+        }
+        obj->setPosition(p);
+        body->setVelocity(v);
+    }
+
+    _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [] (const Entry& entry) {
+        return entry.objId == 0;
+    }), _entries.end());
+}
+
+bool OrbitSystem::enter(VisualObj* obj)
+{
+    PhysicsBody* body = obj->getNode()->getPhysicsBody();
+    if (!body || contains(obj->getId())) {
+        return false;
+    }
+    if (body->isStatic() || dynamic_cast<AstroObj*>(obj)) {
+        return false; // Astro obj bodies are static, moving them would leave their shapes unindexed
+    }
+    Vec2 p = body->getPosition();
+    double mu = 0.0;
+    AstroObj* center = dominantSource(p, &mu);
+    if (!center || center == obj) {
+        return false;
+    }
+    PhysicsBody* centerBody = center->getNode()->getPhysicsBody();
+    Vec2 r = p - centerBody->getPosition();
+    Vec2 v = body->getVelocity() - centerBody->getVelocity();
+    double rlen = r.length();
+    if (v.lengthSquared() / 2 - mu / rlen >= 0.0 || rlen < entryRadius(center)) {
+        return false; // Unbound trajectory or too low
+    }
+    Orbit orbit;
+    if (!orbit.init(center->getId(), mu, r, v, _time)
+        || orbit.e > gOrbitMaxEccentricity) {
+        return false;
+    }
+    _entries.push_back(Entry{obj->getId(), orbit, body->isDynamic()});
+    body->setDynamic(false);
+    return true;
+}
+
+void OrbitSystem::leave(VisualObj* obj)
+{
+    for (Entry& entry : _entries) {
+        if (entry.objId == obj->getId()) {
+            leave(entry, obj, obj->getNode()->getPhysicsBody()->getVelocity());
+        }
+    }
+    _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [] (const Entry& entry) {
+        return entry.objId == 0;
+    }), _entries.end());
+}
+
+void OrbitSystem::leave(Entry& entry, VisualObj* obj, Vec2 v)
+{
+    PhysicsBody* body = obj->getNode()->getPhysicsBody();
+    body->setDynamic(entry.dynamic);
+    body->setVelocity(entry.dynamic? v: Vec2::ZERO);
+    entry.objId = 0;
+}
+
+bool OrbitSystem::contains(Id id) const
+{
+    for (const Entry& entry : _entries) {
+        if (entry.objId == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+AstroObj* OrbitSystem::dominantSource(Vec2 p, double* mu)
+{
+    float G = _game->physicsWorld()->getForceField()->getGravityConstant();
+    AstroObj* ret = nullptr;
+    double maxStrength = 0.0;
+    for (Planet* planet : _game->planets()) {
+        PhysicsBody* body = planet->getNode()->getPhysicsBody();
+        double distSq = (body->getPosition() - p).lengthSquared();
+        if (distSq < 1.0) {
+            continue; // Point is the source itself
+        }
+        double strength = G * body->getMass() / distSq;
+        if (strength > maxStrength) {
+            maxStrength = strength;
+            ret = planet;
+            if (mu) {
+                *mu = G * body->getMass();
+            }
+        }
+    }
+    return ret;
+}
+
+Vec2 OrbitSystem::circularVelocity(Vec2 p)
+{
+    double mu = 0.0;
+    AstroObj* center = dominantSource(p, &mu);
+    if (!center) {
+        return Vec2::ZERO;
+    }
+    PhysicsBody* centerBody = center->getNode()->getPhysicsBody();
+    Vec2 r = p - centerBody->getPosition();
+    float v = sqrt(mu / r.length());
+    return centerBody->getVelocity() + v * r.getNormalized().getPerp();
+}
+
+float OrbitSystem::entryRadius(AstroObj* center)
+{
+    if (Planet* planet = dynamic_cast<Planet*>(center)) {
+        return planet->getAtmosphereRadius();
+    }
+    return center->getSize();
+}
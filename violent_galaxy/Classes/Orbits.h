@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Defs.h"
+
+#include <vector>
+
+class GameScene;
+class AstroObj;
+class VisualObj;
+
+// Keplerian elements of bound orbit around single gravity source
+struct Orbit {
+    Id centerId = 0; // Astro obj in focus
+    double mu = 0.0; // Gravitational parameter of center
+    double a = 0.0; // Semi-major axis
+    double e = 0.0; // Eccentricity
+    double w = 0.0; // World angle of periapsis
+    double dir = 1.0; // Direction of motion: 1 for counterclockwise, -1 for clockwise
+    double m0 = 0.0; // Mean anomaly at epoch
+    double t0 = 0.0; // Epoch
+
+    // Elements from position r and velocity v relative to center at time t, fails if orbit is not bound
+    bool init(Id centerId_, double mu_, cc::Vec2 r, cc::Vec2 v, double t);
+
+    // Position and velocity relative to center at time t
+    void stateAt(double t, cc::Vec2& r, cc::Vec2& v) const;
+
+    double periapsis() const { return a * (1.0 - e); }
+};
+
+// Objects on orbits are not integrated by physics. Their bodies are kinematic and are moved
+// along orbits evaluated analytically from elements, so orbits do not drift and idle orbiters
+// cost nothing to solver. Object returns to physics when it leaves dominance of its center,
+// enters atmosphere or is requested to (e.g. on hit). Astro objs are not supported: their bodies
+// are static and terrain, visibility and minimap data assume they never move
+class OrbitSystem {
+public:
+    void init(GameScene* game);
+    void update(float delta);
+
+    // Puts object on orbit given by its current body state around dominant gravity source, fails for astro objs
+    bool enter(VisualObj* obj);
+    void leave(VisualObj* obj);
+    bool contains(Id id) const;
+
+    // Astro obj with the strongest gravity at world point p
+    AstroObj* dominantSource(cc::Vec2 p, double* mu = nullptr);
+
+    // Velocity of circular orbit through world point p around dominant source
+    cc::Vec2 circularVelocity(cc::Vec2 p);
+private:
+    struct Entry {
+        Id objId;
+        Orbit orbit;
+        bool dynamic; // Body type to restore on leave
+    };
+
+    float entryRadius(AstroObj* center); // Orbits are not allowed below it
+    void leave(Entry& entry, VisualObj* obj, cc::Vec2 v);
+private:
+    GameScene* _game = nullptr;
+    double _time = 0.0;
+    std::vector<Entry> _entries; // In order of entering, so that center is moved before its satellites
+};
@@ -13,7 +13,7 @@ public:
     ShapeTag(T type, ui32 id)
     {
         CCASSERT((id & ~idMask) == 0, "id overflow");
-        _value = ((ui8)type << typeShift) | id;
+        _value = ((ui32)(ui8)type << typeShift) | id;
     }
 
 
@@ -46,9 +46,9 @@ public:
 private:
     ui32 _value;
 
-    static constexpr ui32 idMask = 0xffffff; // 24 bits
-    static constexpr ui32 typeMask = 0xf000000; // 4 bits
-    static constexpr ui32 typeShift = 24;
+    static constexpr ui32 idMask = 0xfffffff; // 28 bits
+    static constexpr ui32 typeMask = 0xf0000000; // 4 bits
+    static constexpr ui32 typeShift = 28;
 };
 
 struct ContactInfo {
@@ -165,6 +165,7 @@ void Player::addSelectionToGroup(size_t idx)
 
 void Player::giveOrder(Unit::Order order, bool add)
 {
+    std::vector<Unit*> units;
     for (Id& id : selected) {
         if (id == 0) {
             continue; // Leave empty space for destroyed units
@@ -176,7 +177,24 @@ void Player::giveOrder(Unit::Order order, bool add)
         }
 
         if (Unit* unit = dynamic_cast<Unit*>(obj)) {
-            unit->giveOrder(order, add);
+            units.push_back(unit);
+        }
+    }
+
+    if (units.size() == 1) {
+        units.front()->giveOrder(order, add);
+    } else if (!units.empty()) {
+        OrderGroup* group = units.front()->getOrderGroup();
+        if (add && group && group->hasSameMembers(units)) {
+            group->addOrder(order); // Queued waypoint is stored once for whole group
+        } else if (add) {
+            for (Unit* unit : units) {
+                unit->giveOrder(order, add);
+            }
+        } else {
+            group = _game->createOrderGroup();
+            group->addMembers(units, order.p);
+            group->addOrder(order);
         }
     }
 }
@@ -217,8 +235,7 @@ void MoronAI::think()
     }
 
     // Assign strategy for newly created tanks
-    for (auto kv : *_game->objs()) {
-        Obj* obj = kv.second;
+    for (Obj* obj : *_game->objs()) {
         if (Tank* tank = dynamic_cast<Tank*>(obj)) {
             Id id = tank->getId();
             if (_tanks.find(id) == _tanks.end() && tank->getPlayer() == _player) {
@@ -340,11 +357,7 @@ void MoronAI::Attacking::think(Tank* tank)
             } else {
                 Polar src = planet->world2polar(tankPos);
                 Polar dst = src;
-                float dir = _dir;
-                if (random<float>(0.0f, 1.0f) < 0.03f) {
-                    dir = -_dir; // Sometimes we need to go backwards to avoid tank hanging bug
-                }
-                dst.a += dir * CC_DEGREES_TO_RADIANS(10);
+                dst.a += _dir * CC_DEGREES_TO_RADIANS(10);
                 Vec2 orderPos = planet->polar2world(dst.r, dst.a);
                 tank->giveOrder(Unit::Order(Unit::OrderType::Move, orderPos), false);
             }
@@ -26,6 +26,7 @@ bool Projectile::onContactAstroObj(ContactInfo& cinfo)
 {
 //    CCLOG("PROJECTILE CONTACT ASTROOBJ id# %d aobjId# %d", (int)_id, (int)cinfo.thatObjTag.id());
 
+    blast();
     destroy();
     return false;
 }
@@ -33,22 +34,41 @@ bool Projectile::onContactAstroObj(ContactInfo& cinfo)
 bool Projectile::onContactUnit(ContactInfo& cinfo)
 {
 //    CCLOG("PROJECTILE CONTACT UNIT id# %d unitId# %d", (int)_id, (int)cinfo.thatObjTag.id());
-    hit(static_cast<Unit*>(cinfo.thatObj));
+    Unit* unit = static_cast<Unit*>(cinfo.thatObj);
+    if (unit->hp <= 0) {
+        return false; // Fly through dying unit, e.g. its own debris
+    }
+    hit(unit);
+    blast();
     destroy();
     return false;
 }
 
+void Projectile::blast()
+{
+    if (_blastRadius > 0.0f) {
+        _game->blasts()->add(_body->getPosition(), _blastRadius, _blastDamage, _blastImpulse);
+    }
+}
+
 void Projectile::hit(Unit* unit)
+{
+    hitUnit(unit, _body->getPosition(), _body->getVelocity(), _body->getMass(), _damage);
+}
+
+void Projectile::hitUnit(Unit* unit, Vec2 p, Vec2 v, float mass, i32 damage)
 {
     if (auto node = unit->getNode()) {
         if (auto hitBody = node->getPhysicsBody()) {
-            Vec2 j = _body->getVelocity() * _body->getMass();
+            Vec2 j = v * mass;
             j *= 10; // Amplify impulse
             hitBody->applyImpulse(
                 hitBody->world2Local(j) - hitBody->world2Local(Vec2::ZERO),
-                hitBody->world2Local(_body->getPosition())
+                hitBody->world2Local(p)
             );
-            unit->damage(_damage);
+            unit->railsLeaveRequested = true; // Impulse is ignored on rails, but next one will not be
+            unit->wake();
+            unit->damage(damage);
         }
     }
 }
@@ -60,8 +80,9 @@ void Projectile::setPlayer(Player* player)
 
 bool Shell::init(GameScene* game)
 {
-    _size = 2;
-    _damage = 30;
+    _size = gBallisticsShellSize;
+    _damage = damageDefault;
+    setBlast(gShellBlastRadius, gShellBlastDamage, gShellBlastImpulse);
     Projectile::init(game);
     return true;
 }
@@ -81,7 +102,11 @@ PhysicsBody* Shell::createBody()
 
 void Shell::draw()
 {
-    node()->drawSolidCircle(Vec2::ZERO, _size, 0, 6, _color);
+    node()->clear();
+    std::string key = std::string(typeid(*this).name()) + "#" + SpriteAtlas::colorKey(_color);
+    drawCached(node(), 0, key, Rect(-_size, -_size, 2 * _size, 2 * _size), [=] (DrawNode* node) {
+        node->drawSolidCircle(Vec2::ZERO, _size, 0, 6, _color);
+    });
 }
 
 float Shell::getSize()
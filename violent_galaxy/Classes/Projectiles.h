@@ -14,16 +14,24 @@ public:
     ObjType getObjType() override;
     void destroy() override;
     virtual void hit(Unit* unit);
+    // Pushes and damages unit hit at world point p by projectile with given velocity and mass
+    static void hitUnit(Unit* unit, cc::Vec2 p, cc::Vec2 v, float mass, i32 damage);
     virtual void setPlayer(Player* player);
     Player* getPlayer() { return _player; }
     void setDamage(i32 damage) { _damage = damage; }
+    // Area damage on impact in addition to damage of unit hit, zero radius disables it
+    void setBlast(float radius, i32 damage, float impulse) { _blastRadius = radius; _blastDamage = damage; _blastImpulse = impulse; }
 protected:
     Projectile() {}
     bool init(GameScene* game) override;
+    void blast();
 protected:
     Player* _player;
     cc::PhysicsBody* _body = nullptr;
     i32 _damage = 1;
+    float _blastRadius = 0.0f;
+    i32 _blastDamage = 0;
+    float _blastImpulse = 0.0f;
 };
 
 class Shell : public Projectile {
@@ -31,6 +39,7 @@ public:
     OBJ_CREATE_FUNC(Shell);
     float getSize() override;
     static constexpr float bodyMass = 0.05f;
+    static constexpr i32 damageDefault = 30;
     void setColor(cc::Color4F color);
 protected:
     Shell() {}
@@ -108,24 +108,60 @@ public:
 
     Iterator locate(float r, float a)
     {
-        i64 ri = (i64)floorf((r - _r1) / _rstep);
+        size_t ri;
+        size_t ai;
+        if (!locateIndex(r, a, ri, ai)) {
+            return Iterator(); // Out of grid range
+        }
+        return Iterator(this, ri, ai);
+    }
+
+    // Returns false if r is out of grid range
+    bool locateIndex(float r, float a, size_t& ri, size_t& ai) const
+    {
+        i64 rii = (i64)floorf((r - _r1) / _rstep);
         if (a < 0) { // Get rid of negative angle (for mod to work right)
             a -= (2 * M_PI) * floorf(a / (2 * M_PI));
             CCASSERT(a >= 0, "angle is still negtive");
         }
-        i64 ai = (i64)floorf(a / _astep) % _asize;
-        CCASSERT(ai >= 0 && ai < _asize, "angle rounding internal error");
-        if (ri < 0 || ri >= _rsize) {
-            return Iterator(); // Out of grid range
+        i64 aii = (i64)floorf(a / _astep) % (i64)_asize;
+        CCASSERT(aii >= 0 && aii < (i64)_asize, "angle rounding internal error");
+        if (rii < 0 || rii >= (i64)_rsize) {
+            return false;
         }
-        return Iterator(this, ri, ai);
+        ri = (size_t)rii;
+        ai = (size_t)aii;
+        return true;
     }
 
 public: // Accessors
-    Cell* getCell(size_t ri, size_t ai)
+    Cell& getCell(size_t ri, size_t ai)
     {
         return _cells[ri * _asize + ai];
     }
+
+    Cell& getCell(size_t idx)
+    {
+        return _cells[idx];
+    }
+
+    const Cell& getCell(size_t ri, size_t ai) const
+    {
+        return _cells[ri * _asize + ai];
+    }
+
+    const Cell& getCell(size_t idx) const
+    {
+        return _cells[idx];
+    }
+
+    size_t getCellIndex(size_t ri, size_t ai) const { return ri * _asize + ai; }
+    float getR1() const { return _r1; }
+    float getR2() const { return _r2; }
+    size_t getRSize() const { return _rsize; }
+    size_t getASize() const { return _asize; }
+    float getRStep() const { return _rstep; }
+    float getAStep() const { return _astep; }
 private:
     float _r1; // starting radius
     float _r2; // ending radius
@@ -0,0 +1,80 @@
+#include "SpriteAtlas.h"
+
+USING_NS_CC;
+
+void SpriteAtlas::init()
+{
+    // Note that render texture is initially filled with transparent black
+    _texture = RenderTexture::create(gSpriteAtlasSize, gSpriteAtlasSize, Texture2D::PixelFormat::RGBA8888);
+}
+
+SpriteFrame* SpriteAtlas::getFrame(const std::string& key, const Rect& bounds, const DrawFunc& func)
+{
+    auto iter = _frames.find(key);
+    if (iter != _frames.end()) {
+        return iter->second.get();
+    }
+
+    float scale = gSpriteAtlasScale;
+    float width = ceilf(bounds.size.width * scale);
+    float height = ceilf(bounds.size.height * scale);
+    Vec2 origin;
+    if (!allocate(width, height, origin)) {
+        return nullptr;
+    }
+
+    // Texture rows go bottom-up, so image is drawn flipped to make frame rect usual top-down one
+    DrawNode* node = DrawNode::create();
+    node->setPosition(origin.x - bounds.getMinX() * scale, origin.y + bounds.getMaxY() * scale);
+    node->setScale(scale, -scale);
+    func(node);
+    _pending.pushBack(node);
+
+    SpriteFrame* frame = SpriteFrame::createWithTexture(
+        _texture->getSprite()->getTexture(),
+        Rect(origin.x, origin.y, width, height)
+    );
+    _frames[key] = frame;
+    return frame;
+}
+
+void SpriteAtlas::flush()
+{
+    _rendering.clear(); // Previous frame has been already rendered
+    if (_pending.empty()) {
+        return;
+    }
+    _texture->begin();
+    for (DrawNode* node : _pending) {
+        node->visit();
+    }
+    _texture->end();
+    _rendering = std::move(_pending);
+    _pending.clear();
+}
+
+std::string SpriteAtlas::colorKey(const Color4F& color)
+{
+    Color4B c(color);
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%02x%02x%02x%02x", c.r, c.g, c.b, c.a);
+    return buf;
+}
+
+bool SpriteAtlas::allocate(float width, float height, Vec2& origin)
+{
+    // Simple shelf packing, cells are never freed
+    float padding = 2.0f; // Avoid bleeding of neighbour images due to filtering
+    if (_shelfX + width + padding > gSpriteAtlasSize) {
+        _shelfX = 0.0f;
+        _shelfY += _shelfHeight;
+        _shelfHeight = 0.0f;
+    }
+    if (_shelfX + width + padding > gSpriteAtlasSize || _shelfY + height + padding > gSpriteAtlasSize) {
+        return false;
+    }
+    origin = Vec2(_shelfX + padding / 2, _shelfY + padding / 2);
+    _shelfX += width + padding;
+    _shelfHeight = std::max(_shelfHeight, height + padding);
+    return true;
+}
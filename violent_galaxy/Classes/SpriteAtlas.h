@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Defs.h"
+#include "base/CCRefPtr.h"
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+// Texture with pre-rasterized images of objects. Every image is drawn once
+// by DrawNode into its own cell and then rendered by sprites, which are batched
+// into few draw calls because they share the same texture
+class SpriteAtlas {
+public:
+    using DrawFunc = std::function<void(cc::DrawNode*)>;
+    static constexpr int spriteTag = 1; // Tag of sprite child created in object node
+public:
+    SpriteAtlas() {}
+    void init();
+
+    // Returns frame with image drawn by func in given local bounds. Image is rasterized on
+    // first request and shared by all objects with the same key. Returns nullptr if atlas is full
+    cc::SpriteFrame* getFrame(const std::string& key, const cc::Rect& bounds, const DrawFunc& func);
+
+    // Renders images requested since last call, should be called once per frame
+    void flush();
+
+    static std::string colorKey(const cc::Color4F& color);
+private:
+    bool allocate(float width, float height, cc::Vec2& origin);
+private:
+    cc::RefPtr<cc::RenderTexture> _texture;
+    std::unordered_map<std::string, cc::RefPtr<cc::SpriteFrame>> _frames;
+    cc::Vector<cc::DrawNode*> _pending; // To be rendered on next flush
+    cc::Vector<cc::DrawNode*> _rendering; // Kept alive until renderer executes their commands
+    float _shelfX = 0.0f;
+    float _shelfY = 0.0f;
+    float _shelfHeight = 0.0f;
+};
@@ -0,0 +1,105 @@
+#include "TerrainDetail.h"
+#include "GameScene.h"
+
+USING_NS_CC;
+
+void TerrainDetail::init(GameScene* game, WorldView* view)
+{
+    _game = game;
+    _view = view;
+}
+
+void TerrainDetail::update(float delta)
+{
+    _timer += delta;
+    if (_timer < gTerrainDetailInterval && _missing.empty()) {
+        return;
+    }
+
+    if (_timer >= gTerrainDetailInterval) {
+        _timer = 0.0f;
+        _stamp++;
+        _missing.clear();
+
+        const std::vector<Planet*>& planets = _game->planets();
+
+        // Visible terrain first, so that player sees it refined as soon as possible
+        if (_view->getZoom() < gTerrainDetailMaxZoom) {
+            Vec2 center = _view->getCenter();
+            float radius = _view->getRadius();
+            for (Planet* planet : planets) {
+                Polar p = planet->world2polar(center);
+                if (p.r < planet->getAtmosphereRadius() + radius) {
+                    want(planet, p.a, radius / std::max(1.0f, std::min(p.r, planet->getCoreRadius())));
+                }
+            }
+        }
+
+        // Terrain units may touch
+        for (Obj* obj : *_game->objs()) {
+            if (Unit* unit = dynamic_cast<Unit*>(obj)) {
+                Vec2 pos = unit->getNode()->getPosition();
+                for (Planet* planet : planets) {
+                    Polar p = planet->world2polar(pos);
+                    if (p.r < planet->getAtmosphereRadius()) {
+                        want(planet, p.a, gTerrainDetailMargin / planet->getCoreRadius());
+                    }
+                }
+            }
+        }
+        std::reverse(_missing.begin(), _missing.end()); // Taken from back
+    }
+
+    // Refine a few chunks per update, chunks that are not wanted now are dropped to make room
+    for (size_t i = 0; i < gTerrainDetailPerUpdate && !_missing.empty(); i++) {
+        Id planetId = _missing.back().first;
+        size_t chunk = _missing.back().second;
+        _missing.pop_back();
+        while (_points > gTerrainDetailBudget && !_entries.empty() && _entries.back().stamp != _stamp) {
+            evict(std::prev(_entries.end()));
+        }
+        if (_points > gTerrainDetailBudget) {
+            _missing.clear(); // Everything refined is wanted, no room for the rest
+            break;
+        }
+        Planet* planet = _game->objs()->getByIdAs<Planet>(planetId);
+        if (!planet) {
+            continue; // Destroyed since check
+        }
+        size_t points = planet->addDetail(chunk);
+        _entries.push_front(Entry{planetId, chunk, points, _stamp});
+        _index[key(planetId, chunk)] = _entries.begin();
+        _points += points;
+    }
+}
+
+void TerrainDetail::want(Planet* planet, float a, float halfWidth)
+{
+    size_t count = planet->getChunkCount();
+    float step = 2 * M_PI / count;
+    i64 k1 = (i64)floorf((a - halfWidth) / step);
+    i64 k2 = std::min(k1 + i64(count) - 1, (i64)floorf((a + halfWidth) / step));
+    for (i64 k = k1; k <= k2; k++) {
+        size_t chunk = size_t((k % i64(count) + i64(count)) % i64(count));
+        auto i = _index.find(key(planet->getId(), chunk));
+        if (i != _index.end()) {
+            Entries::iterator it = i->second;
+            if (it->stamp != _stamp) {
+                it->stamp = _stamp;
+                _entries.splice(_entries.begin(), _entries, it);
+            }
+        } else if (std::find(_missing.begin(), _missing.end(), std::make_pair(planet->getId(), chunk)) == _missing.end()) {
+            _missing.emplace_back(planet->getId(), chunk);
+        }
+    }
+}
+
+void TerrainDetail::evict(Entries::iterator it)
+{
+    if (Planet* planet = _game->objs()->getByIdAs<Planet>(it->planetId)) {
+        planet->removeDetail(it->chunk);
+    }
+    _points -= it->points;
+    _index.erase(key(it->planetId, it->chunk));
+    _entries.erase(it);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Defs.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class GameScene;
+class Planet;
+class WorldView;
+
+// Multi-resolution planet terrain. Coarse profile of every planet is always kept, relief of
+// finer level is generated on demand for chunks near units and for visible chunks when view is
+// zoomed in. Refined chunks are kept in LRU list and the least recently wanted ones fall back
+// to coarse level when number of generated points exceeds budget
+class TerrainDetail {
+public:
+    void init(GameScene* game, WorldView* view);
+    void update(float delta);
+
+    size_t getPoints() const { return _points; }
+private:
+    struct Entry {
+        Id planetId;
+        size_t chunk;
+        size_t points;
+        ui64 stamp; // Last check that wanted this chunk
+    };
+    using Entries = std::list<Entry>;
+
+    void want(Planet* planet, float a, float halfWidth);
+    void evict(Entries::iterator it);
+    static ui64 key(Id planetId, size_t chunk) { return (ui64(planetId) << 32) | chunk; }
+private:
+    GameScene* _game = nullptr;
+    WorldView* _view = nullptr;
+    float _timer = 0.0f;
+    ui64 _stamp = 0;
+    size_t _points = 0;
+    Entries _entries; // The most recently wanted first
+    std::unordered_map<ui64, Entries::iterator> _index;
+    std::vector<std::pair<Id, size_t>> _missing; // Wanted chunks without detail, planet id and chunk
+};
@@ -52,6 +52,9 @@ void Unit::setPlayer(Player* player)
 
 void Unit::damage(i32 value)
 {
+    if (hp <= 0) {
+        return; // Already dying
+    }
     hp -= value;
     if (hp <= 0) {
         Vec2 pos = _rootNode->getPhysicsBody()->getPosition();
@@ -60,23 +63,114 @@ void Unit::damage(i32 value)
             col = player->color;
         }
 
-        // Create boom trash
+        // Create boom trash, most of it is visual only and never gets into physics world
         Vec2 up = -_game->physicsWorld()->getForceField()->getGravity(pos).getNormalized();
-        for (int i = 0; i < 7; i++) {
-            Shell* shell = Shell::create(_game);
-            shell->setColor(col);
-            shell->setDamage(10);
-            shell->setPosition(pos);
-
+        _game->debris()->explode(pos, up, col, gDebrisFragments);
+        for (int i = 0; i < gDebrisDamagingFragments; i++) {
             float angle = CC_DEGREES_TO_RADIANS(random<float>(-60, 60));
             Vec2 j = up * random<float>(10.0f, 25.0f);
             j = j.rotate(Vec2::forAngle(angle));
-            shell->getNode()->getPhysicsBody()->applyTorque(random<float>(-100.0f, 100.0f));
-            shell->getNode()->getPhysicsBody()->applyImpulse(j);
+            if (gBallisticShells) {
+                _game->ballistics()->launch(pos, j / Shell::bodyMass, col, 10, _id);
+            } else {
+                Shell* shell = Shell::create(_game);
+                shell->setColor(col);
+                shell->setDamage(10);
+                shell->setPosition(pos);
+                shell->getNode()->getPhysicsBody()->applyTorque(random<float>(-100.0f, 100.0f));
+                shell->getNode()->getPhysicsBody()->applyImpulse(j);
+            }
         }
+        _game->blasts()->add(pos, getSize() / 2 + gUnitBlastRadius, gUnitBlastDamage, gUnitBlastImpulse);
+
+        // Destruction is deferred, because unit may be killed in the middle of iteration over units (e.g. by blast)
+        die();
+    }
+}
 
-        destroy();
+bool Unit::railsEnter()
+{
+    if (_onRails || !surfaceId || !surfaceIdCount) {
+        return false;
+    }
+    Planet* planet = _game->objs()->getByIdAs<Planet>(surfaceId);
+    if (!planet) {
+        return false;
+    }
+
+    // Do not put flying or bouncing units on rails
+    auto body = _rootNode->getPhysicsBody();
+    Vec2 p = body->getPosition();
+    Vec2 up = (p - planet->getNode()->getPhysicsBody()->getPosition()).getNormalized();
+    if (fabsf(body->getVelocity().dot(up)) > gLodMaxRadialVelocity) {
+        return false;
+    }
+
+    Vec2 mid;
+    Vec2 xdir;
+    _railsAngle = planet->world2polar(p).a;
+    if (!railsFrame(planet, _railsAngle, mid, xdir)) {
+        return false;
+    }
+    _railsHeight = (p - mid).dot(xdir.getPerp());
+    body->setDynamic(false);
+    body->setVelocity(Vec2::ZERO);
+    body->setAngularVelocity(0.0f);
+    _onRails = true;
+    railsLeaveRequested = false;
+    return true;
+}
+
+void Unit::railsLeave()
+{
+    if (!_onRails) {
+        return;
     }
+    auto body = _rootNode->getPhysicsBody();
+    Vec2 xdir = body->local2World(Vec2::UNIT_X) - body->local2World(Vec2::ZERO);
+    body->setDynamic(true);
+    body->setVelocity(xdir * getTargetVelocity());
+    body->setAngularVelocity(0.0f);
+    _onRails = false;
+    railsLeaveRequested = false;
+}
+
+void Unit::railsUpdate(float delta)
+{
+    Planet* planet = _game->objs()->getByIdAs<Planet>(surfaceId);
+    if (!planet) {
+        railsLeave();
+        return;
+    }
+
+    // Move along surface keeping the same height over it
+    float r = planet->world2polar(_rootNode->getPhysicsBody()->getPosition()).r;
+    float a = angleMain(_railsAngle - getTargetVelocity() * delta / r);
+    Vec2 mid;
+    Vec2 xdir;
+    if (!railsFrame(planet, a, mid, xdir)) {
+        railsLeave();
+        return;
+    }
+    _railsAngle = a;
+    setPosition(mid + _railsHeight * xdir.getPerp());
+    _rootNode->setRotation(-CC_RADIANS_TO_DEGREES(xdir.getAngle()));
+}
+
+// Computes surface point under unit center and direction of local Ox axis along surface
+// Note that local Ox axis of unit on surface points toward smaller polar angles
+bool Unit::railsFrame(Planet* planet, float a, Vec2& mid, Vec2& xdir)
+{
+    float da = getSize() / 2 / (planet->getCoreRadius() + planet->getAltitudeAt(a));
+    Vec2 right = planet->altAng2world(planet->getAltitudeAt(a - da), a - da);
+    Vec2 left = planet->altAng2world(planet->getAltitudeAt(a + da), a + da);
+    xdir = right - left;
+    if (xdir.isSmall()) {
+        return false;
+    }
+    xdir.normalize();
+    mid = (right + left) / 2;
+    return true;
 }
 
 void Unit::goBack()
@@ -97,6 +191,10 @@ float Unit::separationVelocityAlong(Vec2 axis)
 
 void Unit::giveOrder(Order order, bool add)
 {
+    wake();
+    if (_orderGroup) {
+        _orderGroup->leave(this, add); // Appended order goes after orders left from group
+    }
     if (!add) {
         stopCurrentOrder();
         _orders.clear();
@@ -107,11 +205,194 @@ void Unit::giveOrder(Order order, bool add)
     _orders.emplace_back(order);
 }
 
+void Unit::handleOrders(float delta)
+{
+    while (!_orders.empty()) {
+        ExecResult result = executeOrder(_orders.front(), 0.0f);
+        if (result == ExecResult::Done) {
+            _orderDelayElapsed = 0;
+            _orders.pop_front();
+            continue; // Handle next order
+        } else if (result == ExecResult::InProgress) {
+            _orderDelayElapsed = 0;
+            break; // Stop handling
+        } else if (result == ExecResult::Delayed) {
+            _orderDelayElapsed += delta;
+            if (_orderDelayElapsed > gOrderDelayTimeout) {
+                _orderDelayElapsed = 0;
+                // Fail order by timeout (see below)
+            } else {
+                break; // Continue trying
+            }
+        }
+
+        // Failed order -- stop all orders in list
+        _orders.clear();
+    }
+}
+
+void Unit::wake()
+{
+    if (auto body = _rootNode->getPhysicsBody()) {
+        body->setResting(false);
+    }
+}
+
 ObjType Unit::getObjType()
 {
     return ObjType::Unit;
 }
 
+void OrderGroup::addMembers(const std::vector<Unit*>& units, Vec2 center)
+{
+    // Sort units along surface, so that nobody has to drive through others to reach its slot
+    std::vector<std::pair<float, Unit*>> sorted;
+    sorted.reserve(units.size());
+    Id planetId = 0;
+    float centerAngle = 0.0f;
+    for (Unit* unit : units) {
+        float key = 0.0f;
+        if (Planet* planet = _game->objs()->getByIdAs<Planet>(unit->surfaceId)) {
+            if (planetId != unit->surfaceId) {
+                planetId = unit->surfaceId;
+                centerAngle = planet->world2polar(center).a;
+            }
+            key = angleDistance(centerAngle, planet->world2polar(unit->getNode()->getPosition()).a);
+        }
+        sorted.emplace_back(key, unit);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [] (const std::pair<float, Unit*>& x, const std::pair<float, Unit*>& y) {
+        return x.first < y.first;
+    });
+
+    float firstOffset = -gFormationSpacing * (sorted.size() - 1) / 2;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        Unit* unit = sorted[i].second;
+        if (unit->_orderGroup) {
+            unit->_orderGroup->leave(unit, false);
+        }
+        unit->stopCurrentOrder();
+        unit->_orders.clear();
+        unit->_orderDelayElapsed = 0;
+        unit->_orderGroup = this;
+        unit->wake();
+        _members.push_back(Member{unit->getId(), _first + _orders.size(), firstOffset + i * gFormationSpacing, 0.0f});
+    }
+}
+
+bool OrderGroup::addOrder(const Unit::Order& order)
+{
+    if (_orders.size() >= gMaxOrders) {
+        return false; // TODO[fate]: add some kind of notification on order ignore
+    }
+    _orders.emplace_back(order);
+    for (Member& m : _members) {
+        if (Unit* unit = _game->objs()->getByIdAs<Unit>(m.id)) {
+            unit->wake();
+        }
+    }
+    return true;
+}
+
+bool OrderGroup::hasSameMembers(const std::vector<Unit*>& units) const
+{
+    size_t count = 0;
+    for (const Member& m : _members) {
+        if (m.id) {
+            count++;
+        }
+    }
+    if (count != units.size()) {
+        return false;
+    }
+    for (Unit* unit : units) {
+        if (unit->_orderGroup != this) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void OrderGroup::leave(Unit* unit, bool keepOrders)
+{
+    if (Member* m = findMember(unit)) {
+        if (keepOrders) {
+            for (size_t i = m->progress - _first; i < _orders.size(); i++) {
+                unit->_orders.push_back(_orders[i]);
+            }
+            unit->_orderDelayElapsed = m->delayElapsed;
+        }
+        m->id = 0; // Removed on next update
+    }
+    unit->_orderGroup = nullptr;
+}
+
+OrderGroup::Member* OrderGroup::findMember(Unit* unit)
+{
+    for (Member& m : _members) {
+        if (m.id == unit->getId()) {
+            return &m;
+        }
+    }
+    return nullptr;
+}
+
+void OrderGroup::update(float delta)
+{
+    size_t done = _first + _orders.size(); // Orders before this index are done by every member
+    for (Member& m : _members) {
+        Unit* unit = _game->objs()->getByIdAs<Unit>(m.id);
+        if (!unit || unit->_orderGroup != this) {
+            m.id = 0;
+            continue;
+        }
+        while (m.progress < _first + _orders.size()) {
+            Unit::Order& order = _orders[m.progress - _first];
+            Unit::ExecResult result = unit->executeOrder(order, m.slotOffset);
+            if (result == Unit::ExecResult::Done) {
+                m.delayElapsed = 0;
+                m.progress++;
+                continue; // Handle next order
+            } else if (result == Unit::ExecResult::InProgress) {
+                m.delayElapsed = 0;
+                break; // Stop handling
+            } else if (result == Unit::ExecResult::Delayed) {
+                m.delayElapsed += delta;
+                if (m.delayElapsed <= gOrderDelayTimeout) {
+                    break; // Continue trying
+                }
+                // Fail order by timeout (see below)
+            }
+
+            // Failed order -- member stops all orders and leaves group
+            unit->_orderGroup = nullptr;
+            m.id = 0;
+            break;
+        }
+        if (m.id) {
+            done = std::min(done, m.progress);
+        }
+    }
+
+    _members.erase(std::remove_if(_members.begin(), _members.end(), [] (const Member& m) {
+        return m.id == 0;
+    }), _members.end());
+    while (_first < done) {
+        _orders.pop_front();
+        _first++;
+    }
+
+    // Idle members do not need group anymore, so it is released
+    if (_orders.empty()) {
+        for (Member& m : _members) {
+            if (Unit* unit = _game->objs()->getByIdAs<Unit>(m.id)) {
+                unit->_orderGroup = nullptr;
+            }
+        }
+        _members.clear();
+    }
+}
+
 bool DropCapsid::init(GameScene* game)
 {
     _size = 20;
@@ -146,17 +427,19 @@ void DropCapsid::draw()
 {
     node()->clear();
     float r = _size / 2;
-    node()->drawSolidCircle(Vec2::ZERO, r, 0, 12, colorFilter(Color4F::WHITE));
-    node()->drawSolidRect(
-        Vec2(-r/10, -9*r/10),
-        Vec2( r/10,  9*r/10),
-        uniformColor()
-    );
-    node()->drawSolidRect(
-        Vec2(-9*r/10, -r/10),
-        Vec2( 9*r/10,  r/10),
-        uniformColor()
-    );
+    drawCached(node(), 0, atlasKey(), Rect(-r, -r, 2*r, 2*r), [=] (DrawNode* node) {
+        node->drawSolidCircle(Vec2::ZERO, r, 0, 12, colorFilter(Color4F::WHITE));
+        node->drawSolidRect(
+            Vec2(-r/10, -9*r/10),
+            Vec2( r/10,  9*r/10),
+            uniformColor()
+        );
+        node->drawSolidRect(
+            Vec2(-9*r/10, -r/10),
+            Vec2( 9*r/10,  r/10),
+            uniformColor()
+        );
+    });
 }
 
 bool DropCapsid::onContactAstroObj(ContactInfo& cinfo)
@@ -242,10 +525,14 @@ bool Tank::shoot()
         Vec2 fromPoint;
         Vec2 dir;
         getShootParams(fromPoint, dir);
-        Projectile* proj = Shell::create(_game);
-        proj->setPosition(fromPoint);
         Vec2 j = dir * _power;
-        proj->getNode()->getPhysicsBody()->applyImpulse(j);
+        if (gBallisticShells) {
+            _game->ballistics()->launch(fromPoint, j / Shell::bodyMass, Color4F::WHITE, Shell::damageDefault, _id);
+        } else {
+            Projectile* proj = Shell::create(_game);
+            proj->setPosition(fromPoint);
+            proj->getNode()->getPhysicsBody()->applyImpulse(j);
+        }
         _body->applyImpulse(_body->world2Local(Vec2::ZERO) - _body->world2Local(j));
         return true;
     } else {
@@ -280,26 +567,48 @@ float Tank::getInitialProjectileVelocity()
 //    _power = clampf(_power + _powerStep, _powerMin, _powerMax);
 //}
 
-Tank::ExecResult Tank::executeMove(Vec2 p)
+Unit::ExecResult Tank::executeOrder(Order& order, float slotOffset)
+{
+    switch (order.type) {
+    case OrderType::Move: return executeMove(order, slotOffset);
+    case OrderType::Aim: return executeAim(order.p);
+    default: return ExecResult::Done;
+    }
+}
+
+Unit::ExecResult Tank::executeMove(Order& order, float slotOffset)
 {
     if (surfaceId) {
         if (Planet* planet = _game->objs()->getByIdAs<Planet>(surfaceId)) {
+            const FlowField* field = nullptr;
+            for (auto& f : order.fields) {
+                if (f->getPlanetId() == surfaceId) {
+                    field = f.get();
+                    break;
+                }
+            }
+            if (!field) {
+                order.fields.push_back(_game->getFlowField(planet, order.p));
+                field = order.fields.back().get();
+            }
             Polar src = planet->world2polar(_body->getPosition());
-            Polar dst = planet->world2polar(p);
-            float aDist = angleDistance(src.a, dst.a);
-            if (fabsf(aDist) * src.r < getSize() / 10) {
-                moveLeft(false);
-                moveRight(false);
-                return ExecResult::Done;
-            } else if (aDist < 0) {
-                moveRight(true);
-                moveLeft(false);
-                return ExecResult::InProgress;
+            float aDist = angleDistance(src.a, field->getDstAngle() + slotOffset / src.r);
+            int dir = 0;
+            if (field->isDestination(src.a) || fabsf(aDist) * src.r < fabsf(slotOffset)) {
+                if (fabsf(aDist) * src.r < getSize() / 10) {
+                    moveLeft(false);
+                    moveRight(false);
+                    return ExecResult::Done;
+                }
+                dir = (aDist < 0? -1: 1);
+            } else if (field->isReachable(src.a)) {
+                dir = field->getDirection(src.a);
             } else {
-                moveRight(false);
-                moveLeft(true);
-                return ExecResult::InProgress;
+                return ExecResult::Failed;
             }
+            moveRight(dir < 0);
+            moveLeft(dir > 0);
+            return ExecResult::InProgress;
         } else {
             return ExecResult::Failed;
         }
@@ -364,7 +673,7 @@ bool Aim(GameScene* game, const AimInfo& info, AimResult& res)
     return true;
 }
 
-//Tank::ExecResult Tank::executeAttack(Id targetId)
+//Unit::ExecResult Tank::executeAttack(Id targetId)
 //{
 //    if (surfaceId) {
 //        if (Planet* planet = _game->objs()->getByIdAs<Planet>(surfaceId)) {
@@ -393,7 +702,7 @@ bool Aim(GameScene* game, const AimInfo& info, AimResult& res)
 //    }
 //}
 
-Tank::ExecResult Tank::executeAim(Vec2 p)
+Unit::ExecResult Tank::executeAim(Vec2 p)
 {
     if (surfaceId) {
         if (Planet* planet = _game->objs()->getByIdAs<Planet>(surfaceId)) {
@@ -439,29 +748,33 @@ void Tank::stopCurrentOrder()
     moveLeft(false);
 }
 
-void Tank::move()
+float Tank::getTargetVelocity()
 {
-    float v = 0.0f;
-
     if (_movingLeft ^ _movingRight) {
-        if (_movingRight) {
-            v += _targetV;
-        } else {
-            v -= _targetV;
-        }
+        return _movingRight? _targetV: -_targetV;
     }
+    return 0.0f;
+}
+
+void Tank::move()
+{
+    float v = getTargetVelocity();
 
     Vec2 xdir = _body->local2World(Vec2::UNIT_X) - _body->local2World(Vec2::ZERO);
     v += separationVelocityAlong(xdir);
 
-    _track->setSurfaceVelocity(-v * xdir);
+    Vec2 surfaceVelocity = -v * xdir;
+    if (surfaceVelocity != _trackSurfaceVelocity) {
+        _trackSurfaceVelocity = surfaceVelocity;
+        _track->setSurfaceVelocity(surfaceVelocity);
+    }
 }
 
 void Tank::rotateGun(float dt)
 {
     if (_rotationSpeed != 0.0f) {
         _angle = clampf(_angle + _angleStep * _rotationSpeed * dt, _angleMin, _angleMax);
-        draw();
+        _gunNode->setRotation(-_angle); // Gun geometry is not changed, see draw()
     }
 }
 
@@ -512,7 +825,12 @@ bool Tank::init(GameScene* game)
 
 Node* Tank::createNodes()
 {
-    return DrawNode::create();
+    auto root = DrawNode::create();
+    _gunNode = DrawNode::create();
+    _gunNode->setPosition(_gunBegin);
+    _gunNode->setRotation(-_angle);
+    root->addChild(_gunNode, -1); // Gun is drawn under hull
+    return root;
 }
 
 PhysicsBody* Tank::createBody()
@@ -535,49 +853,20 @@ PhysicsBody* Tank::createBody()
     return _body;
 }
 
+// Rebuilds geometry, called only if color, Zs or owner is changed
 void Tank::draw()
 {
-    node()->clear();
-    node()->drawSegment(
-        _gunBegin,
-        _gunBegin + _gunLength * Vec2::forAngle(CC_DEGREES_TO_RADIANS(_angle)),
-        1, uniformColor()
-    );
-    node()->drawSolidPoly(_base, sizeof(_base)/sizeof(*_base), colorFilter(Color4F::WHITE));
-    node()->drawSolidPoly(_head, sizeof(_head)/sizeof(*_head), uniformColor());
-}
-
-void Tank::handleOrders(float delta)
-{
-    while (!_orders.empty()) {
-        Order order = _orders.front();
-        ExecResult result = ExecResult::Done;
-        switch (order.type) {
-        case OrderType::Move: result = executeMove(order.p); break;
-        case OrderType::Aim: result = executeAim(order.p); break;
-        default: break;
-        }
-
-        if (result == ExecResult::Done) {
-            _orderDelayElapsed = 0;
-            _orders.pop_front();
-            continue; // Handle next order
-        } else if (result == ExecResult::InProgress) {
-            _orderDelayElapsed = 0;
-            break; // Stop handling
-        } else if (result == ExecResult::Delayed) {
-            _orderDelayElapsed += delta;
-            if (_orderDelayElapsed > gOrderDelayTimeout) {
-                _orderDelayElapsed = 0;
-                // Fail order by timeout (see below)
-            } else {
-                break; // Continue trying
-            }
-        }
+    _gunNode->clear();
+    drawCached(_gunNode, 0, atlasKey() + "#gun", Rect(-1, -1, _gunLength + 2, 2), [=] (DrawNode* node) {
+        node->drawSegment(Vec2::ZERO, Vec2(_gunLength, 0), 1, uniformColor());
+    });
 
-        // Failed order -- stop all orders in list
-        _orders.clear();
-    }
+    node()->clear();
+    Rect bounds(-_bb.width / 2, _base[0].y, _bb.width, _head[2].y - _base[0].y);
+    drawCached(node(), 0, atlasKey(), bounds, [=] (DrawNode* node) {
+        node->drawSolidPoly(_base, sizeof(_base)/sizeof(*_base), colorFilter(Color4F::WHITE));
+        node->drawSolidPoly(_head, sizeof(_head)/sizeof(*_head), uniformColor());
+    });
 }
 
 void Tank::update(float delta)
@@ -585,8 +874,14 @@ void Tank::update(float delta)
     if (!getNode()->getPhysicsBody()) {
         return; // Happens just after creation
     }
-    handleOrders(delta);
-    move();
+    if (!_orderGroup) {
+        handleOrders(delta); // Otherwise orders are handled by group
+    }
+    if (isOnRails()) {
+        railsUpdate(delta);
+    } else {
+        move();
+    }
     rotateGun(delta);
     if (_cooldownLeft > 0) {
         _cooldownLeft -= delta;
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 
 #include "Defs.h"
 #include "Obj.h"
 #include "Physics.h"
+#include "FlowField.h"
+
+class Planet;
+class OrderGroup;
 
 template <class T>
 class TileGrid {
@@ -141,6 +146,8 @@ public:
         OrderType type;
         cc::Vec2 p;
         Id id;
+        // Field for every planet members of group are on, shared by all units moving to the same destination
+        std::vector<std::shared_ptr<const FlowField>> fields;
 
         Order() {}
         Order(OrderType type_, cc::Vec2 p_) : type(type_), p(p_), id(0) {}
@@ -148,6 +155,15 @@ public:
     };
 
     using Orders = std::deque<Order>;
+
+    // Orders execution
+    enum class ExecResult : ui8 {
+        Done,
+        InProgress,
+        Delayed,
+        Failed,
+        MAX
+    };
 public:
     const i32 hpMax;
     const i32 supply; // Supply required by this unit
@@ -164,11 +180,24 @@ public:
     void replaceWith(Unit* unit);
     void setPlayer(Player* player) override;
     void damage(i32 value);
+    float getSightRadius() override { return gUnitSightRadius; }
+    bool isFoggable() override { return true; }
     void goBack();
     void goFront();
     float separationVelocityAlong(cc::Vec2 axis);
     void giveOrder(Order order, bool add);
     virtual void stopCurrentOrder() {}
+    // Slot offset is signed distance along surface from order point to unit's formation slot
+    virtual ExecResult executeOrder(Order& order, float slotOffset) { return ExecResult::Done; }
+    OrderGroup* getOrderGroup() const { return _orderGroup; }
+    void wake();
+public: // Simulation LOD
+    virtual bool canUseRails() { return false; }
+    bool isOnRails() const { return _onRails; }
+    bool railsEnter();
+    void railsLeave();
+    bool railsLeaveRequested = false; // Set on hit to switch back to physics asap
+    virtual bool canUseOrbit() { return false; } // Idle orbiter is moved by OrbitSystem
 protected:
     Unit(i32 hpMax_ = 1, i32 supply_ = 1)
         : supply(supply_)
@@ -176,8 +205,45 @@ protected:
         , hp(hpMax)
     {}
     bool init(GameScene* game) override;
+    void handleOrders(float delta);
+    virtual float getTargetVelocity() { return 0.0f; }
+    void railsUpdate(float delta);
+    bool railsFrame(Planet* planet, float a, cc::Vec2& mid, cc::Vec2& xdir);
 protected:
-    Orders _orders;
+    friend class OrderGroup;
+    Orders _orders; // Used if unit is not a member of order group
+    OrderGroup* _orderGroup = nullptr;
+    float _orderDelayElapsed = 0;
+    bool _onRails = false;
+    float _railsAngle = 0.0f; // Polar angle of unit on rails
+    float _railsHeight = 0.0f; // Height of unit center over surface on rails
+};
+
+// Orders given to a number of units at once. Order queue is shared by all members,
+// every member keeps its own progress and formation slot. Groups are updated
+// by GameScene in one pass before units, members are released when all orders are done
+class OrderGroup {
+public:
+    explicit OrderGroup(GameScene* game) : _game(game) {}
+    void addMembers(const std::vector<Unit*>& units, cc::Vec2 center); // Slots are spread around center
+    bool addOrder(const Unit::Order& order);
+    bool hasSameMembers(const std::vector<Unit*>& units) const;
+    void leave(Unit* unit, bool keepOrders);
+    bool empty() const { return _members.empty(); }
+    void update(float delta);
+private:
+    struct Member {
+        Id id;
+        size_t progress; // Absolute index of order being executed
+        float slotOffset;
+        float delayElapsed;
+    };
+    Member* findMember(Unit* unit);
+private:
+    GameScene* _game;
+    std::vector<Member> _members;
+    Unit::Orders _orders;
+    size_t _first = 0; // Absolute index of _orders.front()
 };
 
 class DropCapsid : public Unit {
@@ -185,6 +251,7 @@ public:
     OBJ_CREATE_FUNC(DropCapsid);
     float getSize() override;
     virtual bool onContactAstroObj(ContactInfo& cinfo) override;
+    bool canUseOrbit() override { return true; }
 protected:
     DropCapsid()
         : Unit(100, 1)
@@ -210,6 +277,7 @@ public:
     cc::Vec2 getShootCenter();
     void getShootParams(cc::Vec2& fromPoint, cc::Vec2& dir);
     bool isGunAnglePossible(float angle);
+    bool canUseRails() override { return true; }
 //    void incAngle(float dt);
 //    void decAngle(float dt);
 //    void subPower();
@@ -223,24 +291,16 @@ protected:
     cc::PhysicsBody* createBody() override;
     void draw() override;
     void update(float delta) override;
-    void handleOrders(float delta);
+    float getTargetVelocity() override;
     void move();
     void rotateGun(float dt);
 
-    // Orders execution
-    enum class ExecResult : ui8 {
-        Done,
-        InProgress,
-        Delayed,
-        Failed,
-        MAX
-    };
-
     void gunRotationSpeed(float speed);
     void moveLeft(bool go);
     void moveRight(bool go);
 
-    ExecResult executeMove(cc::Vec2 p);
+    ExecResult executeOrder(Order& order, float slotOffset) override;
+    ExecResult executeMove(Order& order, float slotOffset);
     ExecResult executeAim(cc::Vec2 p);
 //    ExecResult executeAttack(Id targetId);
 
@@ -248,6 +308,7 @@ protected:
 
 protected:
     cc::DrawNode* node() { return static_cast<cc::DrawNode*>(_rootNode); }
+    cc::DrawNode* _gunNode = nullptr; // Rotates around gun beginning, gun points along Ox
     cc::PhysicsBody* _body = nullptr;
     cc::PhysicsShape* _track = nullptr;
 
@@ -266,6 +327,7 @@ protected:
     float _targetV;
     bool _movingLeft = false;
     bool _movingRight = false;
+    cc::Vec2 _trackSurfaceVelocity; // Last value set, to avoid waking up resting tank
 
     float _angleMin;
     float _angleMax;
@@ -276,14 +338,13 @@ protected:
 
     float _cooldown;
     float _cooldownLeft = 0;
-
-    float _orderDelayElapsed = 0;
 };
 
 class SpaceStation : public Unit {
 public:
     OBJ_CREATE_FUNC(SpaceStation);
     float getSize() override;
+    bool canUseOrbit() override { return true; }
 protected:
     SpaceStation()
         : Unit(1500, 5)
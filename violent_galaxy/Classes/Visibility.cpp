@@ -0,0 +1,380 @@
+#include "Visibility.h"
+#include "GameScene.h"
+
+#include <chrono>
+
+USING_NS_CC;
+
+void Visibility::init(GameScene* game)
+{
+    _game = game;
+    for (Obj* obj : *_game->objs()) {
+        if (Planet* planet = dynamic_cast<Planet*>(obj)) {
+            Layer layer;
+            layer.planetId = planet->getId();
+            layer.crustRadius = 0.0f;
+            for (Vec2 p : planet->crust()) {
+                layer.crustRadius = std::max(layer.crustRadius, p.length());
+            }
+            layer.r1 = planet->getCoreRadius();
+            layer.rsize = (size_t)ceilf((layer.crustRadius + gVisibilityAirAltitude - layer.r1) / gVisibilityCellLength);
+            layer.r2 = layer.r1 + layer.rsize * gVisibilityCellLength;
+            layer.asize = (size_t)ceilf(2 * M_PI * layer.crustRadius / gVisibilityCellLength);
+            layer.asize = (layer.asize + 3) & ~size_t(3); // Rows of mask texture are aligned to 4 bytes
+            _layers.push_back(std::move(layer));
+        }
+    }
+}
+
+void Visibility::update(float delta)
+{
+    _time += delta;
+
+    // Observers are registered by objects themselves, see addObserver()
+    _dirty.clear();
+    for (auto& kv : _observers) {
+        Observer& observer = kv.second;
+        VisualObj* vobj = _game->objs()->getByIdAs<VisualObj>(observer.objId);
+        if (needsFootprint(observer, vobj)) {
+            _dirty.push_back(&observer);
+        }
+    }
+
+    // The most stale footprints first, the rest waits for next updates if time budget is exceeded
+    std::sort(_dirty.begin(), _dirty.end(), [] (Observer* a, Observer* b) {
+        return a->time < b->time;
+    });
+    auto start = std::chrono::high_resolution_clock::now();
+    for (Observer* observer : _dirty) {
+        VisualObj* vobj = _game->objs()->getByIdAs<VisualObj>(observer->objId);
+        applyFootprint(*observer, -1);
+        observer->playerIdx = vobj->getPlayer()->playerId - 1;
+        observer->p = vobj->getNode()->getPosition();
+        observer->cellKey = cellKey(observer->p);
+        observer->radius = vobj->getSightRadius();
+        observer->time = _time;
+        computeFootprint(*observer);
+        applyFootprint(*observer, 1);
+        std::chrono::duration<float> elapsed = std::chrono::high_resolution_clock::now() - start;
+        if (elapsed.count() > gVisibilityUpdateBudget) {
+            break;
+        }
+    }
+}
+
+void Visibility::addObserver(VisualObj* obj)
+{
+    if (!obj->getPlayer() || obj->getSightRadius() <= 0.0f) {
+        removeObserver(obj->getId());
+        return;
+    }
+    auto inserted = _observers.emplace(obj->getId(), Observer());
+    if (inserted.second) {
+        Observer& observer = inserted.first->second;
+        observer.objId = obj->getId();
+        observer.playerIdx = obj->getPlayer()->playerId - 1;
+        observer.p = obj->getNode()->getPosition();
+        observer.radius = obj->getSightRadius();
+    }
+}
+
+void Visibility::removeObserver(Id objId)
+{
+    auto i = _observers.find(objId);
+    if (i != _observers.end()) {
+        applyFootprint(i->second, -1);
+        _observers.erase(i);
+    }
+}
+
+bool Visibility::needsFootprint(Observer& observer, VisualObj* obj)
+{
+    return observer.time < 0.0f
+        || observer.playerIdx != size_t(obj->getPlayer()->playerId - 1)
+        || observer.radius != obj->getSightRadius()
+        || observer.cellKey != cellKey(obj->getNode()->getPosition());
+}
+
+ui64 Visibility::cellKey(Vec2 p)
+{
+    size_t li;
+    size_t ri;
+    size_t ai;
+    if (layerAt(p, li, ri, ai)) {
+        return layerCellKey(li, ri, ai);
+    }
+    return spaceCellKey(p);
+}
+
+ui64 Visibility::layerCellKey(size_t li, size_t ri, size_t ai) const
+{
+    return (1ull << 63) | (ui64(li) << 40) | (ri * _layers[li].asize + ai);
+}
+
+ui64 Visibility::spaceCellKey(Vec2 p) const
+{
+    // Space is split into square cells of the same size
+    i64 xi = (i64)floorf(p.x / gVisibilityCellLength);
+    i64 yi = (i64)floorf(p.y / gVisibilityCellLength);
+    return (ui64(xi & 0x7fffffff) << 32) | ui64(yi & 0xffffffff);
+}
+
+// True if circle around p lies inside of outer circle of some layer, i.e. within layer or planet core
+bool Visibility::insideLayers(Vec2 p, float margin)
+{
+    for (const Layer& layer : _layers) {
+        if (Planet* planet = _game->objs()->getByIdAs<Planet>(layer.planetId)) {
+            if (planet->getNode()->getPosition().distance(p) + margin < layer.r2) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t Visibility::getLayerCount() const
+{
+    return _layers.size();
+}
+
+Id Visibility::getLayerPlanetId(size_t li) const
+{
+    return _layers[li].planetId;
+}
+
+void Visibility::getLayerGeometry(size_t li, float& r1, float& r2, size_t& rsize, size_t& asize) const
+{
+    const Layer& layer = _layers[li];
+    r1 = layer.r1;
+    r2 = layer.r2;
+    rsize = layer.rsize;
+    asize = layer.asize;
+}
+
+ui64 Visibility::getLayerVersion(size_t li, Player* player) const
+{
+    const Layer& layer = _layers[li];
+    size_t playerIdx = player->playerId - 1;
+    return (playerIdx < layer.versions.size()? layer.versions[playerIdx]: 0);
+}
+
+void Visibility::getLayerMask(size_t li, Player* player, ui8* mask) const
+{
+    const Layer& layer = _layers[li];
+    size_t playerIdx = player->playerId - 1;
+    size_t count = layer.rsize * layer.asize;
+    if (playerIdx >= layer.grids.size()) {
+        std::fill(mask, mask + count, 0);
+        return;
+    }
+    const RadialGrid<Cell>& g = layer.grids[playerIdx];
+    for (size_t idx = 0; idx < count; idx++) {
+        mask[idx] = (g.getCell(idx).observers > 0? 255: 0);
+    }
+}
+
+bool Visibility::lineOfSight(Vec2 a, Vec2 b) const
+{
+    Vec2 d = b - a;
+    float len = d.length();
+    if (len == 0.0f) {
+        return true;
+    }
+    Vec2 u = d / len;
+    for (const Layer& layer : _layers) {
+        Planet* planet = _game->objs()->getByIdAs<Planet>(layer.planetId);
+        if (!planet) {
+            continue;
+        }
+
+        // Clip segment by circle that contains all terrain
+        Vec2 f = a - planet->getNode()->getPosition();
+        float b2 = f.dot(u);
+        float disc = b2 * b2 - (f.lengthSquared() - layer.crustRadius * layer.crustRadius);
+        if (disc <= 0.0f) {
+            continue;
+        }
+        float sq = sqrtf(disc);
+        float t1 = std::max(0.0f, -b2 - sq);
+        float t2 = std::min(len, -b2 + sq);
+        if (t1 >= t2) {
+            continue;
+        }
+
+        // March along altitude profile. Samples near ends are skipped, so that objects touching ground are visible
+        float core = planet->getCoreRadius();
+        int samples = (int)ceilf((t2 - t1) / gVisibilityLosStep);
+        for (int k = 0; k <= samples; k++) {
+            float t = t1 + (t2 - t1) * k / std::max(1, samples);
+            if (t < gVisibilityLosStep / 2 || t > len - gVisibilityLosStep / 2) {
+                continue;
+            }
+            Polar polar = planet->world2polar(a + u * t);
+            if (polar.r < core + planet->getAltitudeAt(polar.a)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Visibility::isVisible(Player* player, Vec2 p)
+{
+    if (!player) {
+        return true;
+    }
+    size_t playerIdx = player->playerId - 1;
+    size_t li;
+    size_t ri;
+    size_t ai;
+    if (layerAt(p, li, ri, ai)) {
+        Layer& layer = _layers[li];
+        return playerIdx < layer.grids.size() && layer.grids[playerIdx].getCell(ri, ai).observers > 0;
+    }
+
+    if (playerIdx >= _space.size()) {
+        return false;
+    }
+    auto i = _space[playerIdx].find(spaceCellKey(p));
+    return i != _space[playerIdx].end() && i->second > 0;
+}
+
+void Visibility::getCellState(Player* player, Vec2 p, ui64& key, ui64& version)
+{
+    size_t playerIdx = player->playerId - 1;
+    size_t li;
+    size_t ri;
+    size_t ai;
+    if (layerAt(p, li, ri, ai)) {
+        key = layerCellKey(li, ri, ai);
+        version = getLayerVersion(li, player);
+    } else {
+        key = spaceCellKey(p);
+        version = (playerIdx < _spaceVersions.size()? _spaceVersions[playerIdx]: 0);
+    }
+}
+
+bool Visibility::layerAt(Vec2 p, size_t& li, size_t& ri, size_t& ai)
+{
+    for (li = 0; li < _layers.size(); li++) {
+        Layer& layer = _layers[li];
+        if (Planet* planet = _game->objs()->getByIdAs<Planet>(layer.planetId)) {
+            float d2 = planet->getNode()->getPosition().distanceSquared(p);
+            if (d2 >= layer.r2 * layer.r2 || d2 < layer.r1 * layer.r1) {
+                continue; // Skip atan2 for grids far away
+            }
+            Polar polar = planet->world2polar(p);
+            if (polar.r >= layer.r1 && polar.r < layer.r2) {
+                ri = std::min(layer.rsize - 1, (size_t)((polar.r - layer.r1) / gVisibilityCellLength));
+                ai = (size_t)floorf(angleMain(polar.a) / (2 * M_PI / layer.asize)) % layer.asize;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+RadialGrid<Visibility::Cell>& Visibility::grid(size_t li, size_t playerIdx)
+{
+    Layer& layer = _layers[li];
+    while (layer.grids.size() <= playerIdx) {
+        layer.grids.emplace_back(layer.r1, layer.r2, layer.rsize, layer.asize);
+        layer.versions.push_back(0);
+    }
+    return layer.grids[playerIdx];
+}
+
+void Visibility::applyFootprint(Observer& observer, int sign)
+{
+    for (auto& cell : observer.cells) {
+        ui16& observers = grid(cell.first, observer.playerIdx).getCell(cell.second).observers;
+        if (observers == 0 || observers + sign == 0) {
+            _layers[cell.first].versions[observer.playerIdx]++; // Cell becomes seen or hidden
+        }
+        observers += sign;
+    }
+    if (!observer.spaceCells.empty()) {
+        if (_space.size() <= observer.playerIdx) {
+            _space.resize(observer.playerIdx + 1);
+            _spaceVersions.resize(observer.playerIdx + 1, 0);
+        }
+        auto& space = _space[observer.playerIdx];
+        for (ui64 key : observer.spaceCells) {
+            ui16& observers = space[key];
+            if (observers == 0 || observers + sign == 0) {
+                _spaceVersions[observer.playerIdx]++; // Cell becomes seen or hidden
+            }
+            observers += sign;
+            if (observers == 0) {
+                space.erase(key);
+            }
+        }
+    }
+}
+
+void Visibility::computeFootprint(Observer& observer)
+{
+    observer.cells.clear();
+    observer.spaceCells.clear();
+    float radius = observer.radius;
+
+    // Out of layers only planets themselves may block sight. Cells entirely inside of layers are skipped,
+    // so that observers on ground do not pay for space
+    float cell = gVisibilityCellLength;
+    if (!insideLayers(observer.p, radius)) {
+        i64 x1 = (i64)floorf((observer.p.x - radius) / cell);
+        i64 x2 = (i64)floorf((observer.p.x + radius) / cell);
+        i64 y1 = (i64)floorf((observer.p.y - radius) / cell);
+        i64 y2 = (i64)floorf((observer.p.y + radius) / cell);
+        for (i64 xi = x1; xi <= x2; xi++) {
+            for (i64 yi = y1; yi <= y2; yi++) {
+                Vec2 p((xi + 0.5f) * cell, (yi + 0.5f) * cell);
+                if (p.distanceSquared(observer.p) <= radius * radius
+                    && !insideLayers(p, cell * float(M_SQRT1_2))
+                    && lineOfSight(observer.p, p)) {
+                    observer.spaceCells.push_back(spaceCellKey(p));
+                }
+            }
+        }
+    }
+
+    for (size_t li = 0; li < _layers.size(); li++) {
+        Layer& layer = _layers[li];
+        Planet* planet = _game->objs()->getByIdAs<Planet>(layer.planetId);
+        if (!planet) {
+            continue;
+        }
+        Polar polar = planet->world2polar(observer.p);
+        if (polar.r - radius >= layer.r2 || polar.r + radius < layer.r1) {
+            continue; // Sight circle does not touch grid
+        }
+        RadialGrid<Cell>& g = grid(li, observer.playerIdx);
+        float rstep = g.getRStep();
+        float astep = g.getAStep();
+        i64 asize = (i64)layer.asize;
+        i64 ri1 = std::max<i64>(0, (i64)floorf((polar.r - radius - layer.r1) / rstep));
+        i64 ri2 = std::min<i64>((i64)layer.rsize - 1, (i64)floorf((polar.r + radius - layer.r1) / rstep));
+        i64 aspan = (polar.r > radius? (i64)ceilf(asinf(radius / polar.r) / astep) + 1: asize);
+        i64 acount = std::min(2 * aspan + 1, asize);
+        i64 a0 = (acount == asize? 0: (i64)floorf(angleMain(polar.a) / astep) - aspan);
+        float core = planet->getCoreRadius();
+        for (i64 ri = ri1; ri <= ri2; ri++) {
+            float rbottom = layer.r1 + ri * rstep;
+            for (i64 k = 0; k < acount; k++) {
+                i64 ai = ((a0 + k) % asize + asize) % asize;
+                float a = (ai + 0.5f) * astep;
+
+                // Cell is seen if its lowest point above ground is seen
+                float ground = core + planet->getAltitudeAt(a);
+                float r = std::max(rbottom + rstep / 2, ground + 1.0f);
+                if (r >= rbottom + rstep) {
+                    continue; // Cell is under ground
+                }
+                Vec2 p = planet->polar2world(r, a);
+                if (p.distanceSquared(observer.p) <= radius * radius && lineOfSight(observer.p, p)) {
+                    observer.cells.emplace_back(li, g.getCellIndex(ri, ai));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Defs.h"
+#include "RadialGrid.h"
+
+#include <unordered_map>
+#include <vector>
+
+class GameScene;
+class Planet;
+class Player;
+class VisualObj;
+
+// Line of sight over planet terrain and visibility of world points for every player.
+// Line of sight is ray-marched against altitude profile of crust instead of physics raycasts.
+// Space around every planet is divided into cells by angle and altitude bands, the rest of space
+// into square cells, every cell counts observers of every player that see it. Footprint of observer
+// (list of cells it sees) is recomputed only after it crosses cell boundary, so query is just a cell lookup
+class Visibility {
+public:
+    void init(GameScene* game);
+    void update(float delta);
+
+    // Called by object whenever it gets or loses player, and on destroy. Objects of players with sight are observers
+    void addObserver(VisualObj* obj);
+    void removeObserver(Id objId);
+
+    // True if segment between world points is not blocked by terrain of any planet
+    bool lineOfSight(cc::Vec2 a, cc::Vec2 b) const;
+
+    // True if world point is seen by any observer of player, everything is visible without player
+    bool isVisible(Player* player, cc::Vec2 p);
+
+    // Cell containing world point and version of its visibility for player. Point may change
+    // visibility only if one of them changes, so callers can skip isVisible() otherwise
+    void getCellState(Player* player, cc::Vec2 p, ui64& key, ui64& version);
+
+    // Grids around planets, e.g. to draw fog of war
+    size_t getLayerCount() const;
+    Id getLayerPlanetId(size_t li) const;
+    void getLayerGeometry(size_t li, float& r1, float& r2, size_t& rsize, size_t& asize) const;
+    ui64 getLayerVersion(size_t li, Player* player) const; // Changes whenever any cell becomes seen or hidden for player
+    void getLayerMask(size_t li, Player* player, ui8* mask) const; // 255 for seen cells, rsize rows of asize bytes
+private:
+    struct Cell {
+        ui16 observers = 0;
+    };
+
+    struct Layer {
+        Id planetId;
+        float crustRadius; // Terrain is never higher
+        float r1; // Grid geometry shared by grids of all players
+        float r2;
+        size_t rsize;
+        size_t asize;
+        std::vector<RadialGrid<Cell>> grids; // Index is player id - 1
+        std::vector<ui64> versions;
+    };
+
+    struct Observer {
+        Id objId;
+        size_t playerIdx;
+        cc::Vec2 p; // Position footprint was computed for
+        ui64 cellKey = 0; // Footprint is recomputed when observer moves to another cell
+        float radius;
+        float time = -1.0f; // When footprint was computed, negative if never
+        std::vector<std::pair<size_t, size_t>> cells; // Layer and cell index
+        std::vector<ui64> spaceCells; // Keys of square cells out of layers
+    };
+
+    bool layerAt(cc::Vec2 p, size_t& li, size_t& ri, size_t& ai);
+    RadialGrid<Cell>& grid(size_t li, size_t playerIdx);
+    void applyFootprint(Observer& observer, int sign);
+    bool needsFootprint(Observer& observer, VisualObj* obj);
+    ui64 cellKey(cc::Vec2 p);
+    ui64 layerCellKey(size_t li, size_t ri, size_t ai) const;
+    ui64 spaceCellKey(cc::Vec2 p) const;
+    bool insideLayers(cc::Vec2 p, float margin);
+    void computeFootprint(Observer& observer);
+private:
+    GameScene* _game = nullptr;
+    float _time = 0.0f;
+    std::vector<Layer> _layers;
+    std::vector<std::unordered_map<ui64, ui16>> _space; // Observer counts of seen square cells, index is player id - 1
+    std::vector<ui64> _spaceVersions; // Changes whenever any square cell becomes seen or hidden for player
+    std::unordered_map<Id, Observer> _observers;
+    std::vector<Observer*> _dirty;
+};
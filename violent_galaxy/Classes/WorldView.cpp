@@ -39,8 +39,7 @@ WorldViewAction* WorldView::zoom(float scaleBy, float duration)
     float zoom2 = clampf(_state.zoom * scaleBy, _zoomMin, _zoomMax);
     if (duration == 0.0f) {
         _state.zoom = zoom2;
-        removeWorldCamera();
-        createWorldCamera();
+        syncCamera();
         return nullptr;
     } else {
         WorldViewAction* action = WorldViewAction::createLinear(EActionCategory::Zoom, duration);
@@ -59,8 +58,7 @@ WorldViewAction* WorldView::zoomTo(float scaleBy, Vec2 point, float duration)
     if (duration == 0.0f) {
         _state.zoom = zoom2;
         _state.center = center2;
-        removeWorldCamera();
-        createWorldCamera();
+        syncCamera();
         return nullptr;
     } else {
         WorldViewAction* action = WorldViewAction::createLinear(EActionCategory::Zoom, duration);
@@ -73,7 +71,7 @@ WorldViewAction* WorldView::rotate(float rotateBy, float duration)
 {
     if (duration == 0.0f) {
         _state.rotation += rotateBy;
-        centerAt(_state.center, 0.0f); // Just to enforce redraw
+        syncCamera();
         return nullptr;
     } else {
         WorldViewAction* action = WorldViewAction::createLinear(EActionCategory::Rotate, duration);
@@ -228,9 +226,12 @@ Vec2 WorldView::world2screen(Vec2 w)
     return Vec2(s.x, s.y);
 }
 
-void WorldView::removeWorldCamera()
+bool WorldView::isVisible(Vec2 p, float radius) const
 {
-    _camera->removeFromParent();
+    // Check against visible rectangle in screen-aligned coordinates
+    Vec2 d = (p - _state.center).unrotate(Vec2::forAngle(_state.rotation - M_PI_2));
+    Vec2 half = _state.getSize() / 2;
+    return fabsf(d.x) <= half.x + radius && fabsf(d.y) <= half.y + radius;
 }
 
 void WorldView::createWorldCamera()
@@ -242,22 +243,34 @@ void WorldView::createWorldCamera()
     );
     _camera->setCameraFlag(gWorldCameraFlag);
     _camera->setPositionZ(1.0f);
+    _cameraSize = size;
 
-    centerAt(_state.center, 0.0f);
+    syncCamera();
     _game->addChild(_camera);
 }
 
+// Camera is created once, later only its projection and view are updated if required
+void WorldView::syncCamera()
+{
+    Vec2 size = _state.getSize();
+    if (size != _cameraSize) {
+        _cameraSize = size;
+        _camera->initOrthographic(size.x, size.y, _nearPlane, _farPlane);
+    }
+    Vec2 eye = _state.getEye();
+    if (eye != _cameraEye || _state.rotation != _cameraRotation) {
+        _cameraEye = eye;
+        _cameraRotation = _state.rotation;
+        _camera->setPosition(eye);
+        _camera->lookAt(Vec3(eye.x, eye.y, 0.0f), _state.getUp());
+    }
+}
+
 WorldViewAction* WorldView::applyState(const WorldView::State& state, EActionCategory category, float duration)
 {
     if (duration == 0.0f) {
-        if (state.zoom == state.zoom) {
-            _state = state;
-            centerAt(_state.center, 0.0f);
-        } else {
-            _state = state;
-            removeWorldCamera();
-            createWorldCamera();
-        }
+        _state = state;
+        syncCamera();
         return nullptr;
     } else {
         WorldViewAction* action = WorldViewAction::createLinear(category, duration);
@@ -273,9 +286,7 @@ WorldViewAction* WorldView::centerAt(Vec2 center, float duration)
 {
     if (duration == 0.0f) {
         _state.center = center;
-        Vec2 eye = _state.getEye();
-        _camera->setPosition(eye);
-        _camera->lookAt(Vec3(eye.x, eye.y, 0.0f), _state.getUp());
+        syncCamera();
         return nullptr;
     } else {
         WorldViewAction* action = WorldViewAction::createLinear(EActionCategory::Move, duration);
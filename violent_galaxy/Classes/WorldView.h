@@ -74,9 +74,11 @@ public:
     float angleDiff(float phi, float psi);
     float getZoom() const { return _state.zoom; }
     cc::Vec2 getCenter() const { return _state.center; }
+    float getRadius() const { return _state.getSize().length() / 2; } // Radius of circle around visible area
+    bool isVisible(cc::Vec2 p, float radius) const; // Whether circle intersects visible area
 private:
-    void removeWorldCamera();
     void createWorldCamera();
+    void syncCamera();
     WorldViewAction* applyState(const State& state, EActionCategory category, float duration);
     WorldViewAction* centerAt(cc::Vec2 center, float duration);
     State getViewStateAtPoint(cc::Vec2 center, bool zoomIfRequired, Id surfaceId) const;
@@ -88,6 +90,11 @@ private:
 
     State _state;
 
+    // Last values applied to camera, to update it only on actual change of state
+    cc::Vec2 _cameraSize;
+    cc::Vec2 _cameraEye;
+    float _cameraRotation = NAN;
+
     // TODO[fate]: use plain vector/array
     std::map<EActionCategory, ui32> _actionsInFly;
     std::map<EActionCategory, ui32> _actionsMaxInFly;
@@ -302,6 +302,7 @@ void Node::setRotation(float rotation)
     
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
     
     updateRotationQuat();
 }
@@ -319,6 +320,7 @@ void Node::setRotation3D(const Vec3& rotation)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 
     _rotationX = rotation.x;
     _rotationY = rotation.y;
@@ -370,6 +372,7 @@ void Node::setRotationQuat(const Quaternion& quat)
     _rotationQuat = quat;
     updateRotation3D();
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 }
 
 Quaternion Node::getRotationQuat() const
@@ -384,6 +387,7 @@ void Node::setRotationSkewX(float rotationX)
     
     _rotationZ_X = rotationX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
     
     updateRotationQuat();
 }
@@ -400,6 +404,7 @@ void Node::setRotationSkewY(float rotationY)
     
     _rotationZ_Y = rotationY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
     
     updateRotationQuat();
 }
@@ -419,6 +424,7 @@ void Node::setScale(float scale)
     
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 }
 
 /// scaleX getter
@@ -436,6 +442,7 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 }
 
 /// scaleX setter
@@ -446,6 +453,7 @@ void Node::setScaleX(float scaleX)
     
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 }
 
 /// scaleY getter
@@ -462,6 +470,7 @@ void Node::setScaleZ(float scaleZ)
     
     _scaleZ = scaleZ;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 }
 
 /// scaleY getter
@@ -478,6 +487,7 @@ void Node::setScaleY(float scaleY)
     
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 }
 
 
@@ -508,6 +518,7 @@ void Node::setPosition(float x, float y)
     _position.y = y;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
     _usingNormalizedPosition = false;
 }
 
@@ -573,6 +584,7 @@ void Node::setNormalizedPosition(const Vec2& position)
     _usingNormalizedPosition = true;
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markPhysicsOwnerChanged();
 }
 
 ssize_t Node::getChildrenCount() const
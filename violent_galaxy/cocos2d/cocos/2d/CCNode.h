@@ -1856,7 +1856,16 @@ protected:
     void updateRotationQuat();
     // update Rotation3D from quaternion
     void updateRotation3D();
-    
+
+    // queue check of physics body owner by the next physics sync, called by transform setters
+    void markPhysicsOwnerChanged()
+    {
+#if CC_USE_PHYSICS
+        if (_physicsBody)
+            _physicsBody->markOwnerChanged();
+#endif
+    }
+
 private:
     void addChildHelper(Node* child, int localZOrder, int tag, const std::string &name, bool setTag);
     
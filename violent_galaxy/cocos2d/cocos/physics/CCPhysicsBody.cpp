@@ -55,17 +55,15 @@ static void internalBodyUpdateVelocity(cpBody *body, cpVect gravity, cpFloat dam
 
 
     cocos2d::PhysicsBody *physicsBody = static_cast<cocos2d::PhysicsBody*>(body->userData);
-    if (cocos2d::PhysicsWorld* world = physicsBody->getWorld()) {
+    if (physicsBody->getWorld()) {
         // Apply custom forces and torques
         if (physicsBody->hasUpdateVelocityFunc()) {
             physicsBody->applyUpdateVelocityFunc(body, dt);
         }
 
-        // Apply force fields
-        cocos2d::PhysicsForceField* ff = world->getForceField();
-        if (ff) {
-            acc = cpvadd(acc, ff->getGravity(cpBodyGetPosition(body)));
-        }
+        // Apply force fields, gravity was evaluated by world before step
+        const cocos2d::Vec2& fieldGravity = physicsBody->getFieldGravity();
+        acc = cpvadd(acc, cpv(fieldGravity.x, fieldGravity.y));
         if (physicsBody->isGravityEnabled()) {
             acc = cpvadd(acc, gravity);
         }
@@ -100,6 +98,7 @@ PhysicsBody::PhysicsBody()
 : _world(nullptr)
 , _cpBody(nullptr)
 , _dynamic(true)
+, _static(false)
 , _rotationEnabled(true)
 , _gravityEnabled(true)
 , _massDefault(true)
@@ -121,6 +120,19 @@ PhysicsBody::PhysicsBody()
 , _momentSetByUser(false)
 , _recordScaleX(1.f)
 , _recordScaleY(1.f)
+, _prevPosition(Vec2::ZERO)
+, _prevAngle(0.0)
+, _rendered(false)
+, _renderPosX(0.0f)
+, _renderPosY(0.0f)
+, _renderRotation(0.0f)
+, _ownerPosX(0.0f)
+, _ownerPosY(0.0f)
+, _ownerRotation(0.0f)
+, _ownerScaleX(1.0f)
+, _ownerScaleY(1.0f)
+, _syncStamp(0)
+, _ownerMarked(false)
 {
     _name = COMPONENT_NAME;
 }
@@ -333,6 +345,7 @@ void PhysicsBody::setDynamic(bool dynamic)
         _dynamic = dynamic;
         if (dynamic)
         {
+            _static = false;
             cpBodySetType(_cpBody, CP_BODY_TYPE_DYNAMIC);
             internalBodySetMass(_cpBody, _mass);
             cpBodySetMoment(_cpBody, _moment);
@@ -344,6 +357,16 @@ void PhysicsBody::setDynamic(bool dynamic)
     }
 }
 
+void PhysicsBody::setStatic(bool isStatic)
+{
+    if (isStatic != _static)
+    {
+        setDynamic(false);
+        _static = isStatic;
+        cpBodySetType(_cpBody, isStatic ? CP_BODY_TYPE_STATIC : CP_BODY_TYPE_KINEMATIC);
+    }
+}
+
 void PhysicsBody::setRotationEnable(bool enable)
 {
     if (_rotationEnabled != enable)
@@ -363,6 +386,11 @@ void PhysicsBody::setRotation(float rotation)
     _recordedRotation = rotation;
     _recordedAngle = - (rotation + _rotationOffset) * (M_PI / 180.0);
     cpBodySetAngle(_cpBody, _recordedAngle);
+    _prevAngle = _recordedAngle; // Teleport, do not interpolate
+    if (_world)
+    {
+        _world->markBodyMoved(this);
+    }
 }
 
 void PhysicsBody::setScale(float scaleX, float scaleY)
@@ -393,6 +421,11 @@ void PhysicsBody::setPosition(float positionX, float positionY)
     tt.y = positionY + _positionOffset.y;
 
     cpBodySetPosition(_cpBody, tt);
+    _prevPosition.set(tt.x, tt.y); // Teleport, do not interpolate
+    if (_world)
+    {
+        _world->markBodyMoved(this);
+    }
 }
 
 Vec2 PhysicsBody::getPosition() const
@@ -763,6 +796,9 @@ void PhysicsBody::setEnabled(bool enable)
             if (enable)
             {
                 _world->addBodyOrDelay(this);
+                // Owner could be moved while body was disabled
+                _world->markBodyMoved(this);
+                markOwnerChanged();
             }else
             {
                 _world->removeBodyOrDelay(this);
@@ -908,16 +944,25 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat
         setScale(scaleX, scaleY);
     }
 
+    // Owner is authoritative only if it was changed since the last afterSimulation(). Otherwise it shows
+    // (possibly interpolated) state taken from body, which must not be written back to body
+
     // set rotation
-    if (_recordedRotation != rotation)
+    if (!_rendered || _renderRotation != rotation)
     {
         setRotation(rotation);
     }
 
-    // set position
+    // set position only if node was moved, because setting position wakes up sleeping body
     auto worldPosition = _ownerCenterOffset;
     nodeToWorldTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
-    setPosition(worldPosition.x, worldPosition.y);
+    const float epsilon = 1e-6f;
+    if (!_rendered
+        || fabsf(worldPosition.x - _renderPosX) > epsilon * std::max(1.f, fabsf(_renderPosX))
+        || fabsf(worldPosition.y - _renderPosY) > epsilon * std::max(1.f, fabsf(_renderPosY)))
+    {
+        setPosition(worldPosition.x, worldPosition.y);
+    }
 
     _recordPosX = worldPosition.x;
     _recordPosY = worldPosition.y;
@@ -928,13 +973,24 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat
         _offset.x = worldPosition.x - _owner->getPositionX();
         _offset.y = worldPosition.y - _owner->getPositionY();
     }
+    recordOwnerState();
 }
 
-void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float parentRotation)
+void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float parentRotation, float alpha)
 {
+    // interpolate between previous and current states
+    cpVect pos = cpBodyGetPosition(_cpBody);
+    cpFloat angle = cpBodyGetAngle(_cpBody);
+    if (alpha < 1.0f)
+    {
+        pos = cpvlerp(cpv(_prevPosition.x, _prevPosition.y), pos, alpha);
+        angle = _prevAngle + (angle - _prevAngle) * alpha;
+    }
+
     // set Node position   
-    auto tmp = getPosition();
-    Vec3 positionInParent(tmp.x, tmp.y, 0.f);
+    Vec3 positionInParent(pos.x - _positionOffset.x, pos.y - _positionOffset.y, 0.f);
+    _renderPosX = positionInParent.x;
+    _renderPosY = positionInParent.y;
     if (_recordPosX != positionInParent.x || _recordPosY != positionInParent.y)
     {
         parentToWorldTransform.getInversed().transformVector(positionInParent.x, positionInParent.y, positionInParent.z, 1.f, &positionInParent);
@@ -942,7 +998,70 @@ void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float pare
     }
 
     // set Node rotation
-    _owner->setRotation(getRotation() - parentRotation);
+    float rotation = (angle == cpBodyGetAngle(_cpBody)? getRotation(): - angle * 180.0 / M_PI - _rotationOffset);
+    _owner->setRotation(rotation - parentRotation);
+    _renderRotation = parentRotation + _owner->getRotation();
+    _rendered = true;
+    recordOwnerState();
+}
+
+void PhysicsBody::saveInterpolationState()
+{
+    cpVect pos = cpBodyGetPosition(_cpBody);
+    _prevPosition.set(pos.x, pos.y);
+    _prevAngle = cpBodyGetAngle(_cpBody);
+}
+
+bool PhysicsBody::isOwnerChanged() const
+{
+    return !_rendered
+        || _owner->getPositionX() != _ownerPosX
+        || _owner->getPositionY() != _ownerPosY
+        || _owner->getRotation() != _ownerRotation
+        || _owner->getScaleX() != _ownerScaleX
+        || _owner->getScaleY() != _ownerScaleY;
+}
+
+void PhysicsBody::recordOwnerState()
+{
+    _ownerPosX = _owner->getPositionX();
+    _ownerPosY = _owner->getPositionY();
+    _ownerRotation = _owner->getRotation();
+    _ownerScaleX = _owner->getScaleX();
+    _ownerScaleY = _owner->getScaleY();
+}
+
+void PhysicsBody::markOwnerChanged()
+{
+    if (_world && !_ownerMarked && !_world->_syncingNodes)
+    {
+        _ownerMarked = true;
+        _world->_ownerBodies.push_back(this);
+    }
+}
+
+void PhysicsBody::applyFieldGravity(float gx, float gy, bool worldGravity)
+{
+    bool custom = _updateVelocityFunc
+        || _velocityLimit != PHYSICS_INFINITY
+        || _angularVelocityLimit != PHYSICS_INFINITY
+        || (worldGravity && !_gravityEnabled);
+    if (custom)
+    {
+        _fieldGravity.set(gx, gy);
+        if (_cpBody->velocity_func != internalBodyUpdateVelocity)
+        {
+            cpBodySetVelocityUpdateFunc(_cpBody, internalBodyUpdateVelocity);
+        }
+    }
+    else
+    {
+        _cpBody->f = cpvadd(_cpBody->f, cpvmult(cpv(gx, gy), _cpBody->m));
+        if (_cpBody->velocity_func != cpBodyUpdateVelocity)
+        {
+            cpBodySetVelocityUpdateFunc(_cpBody, cpBodyUpdateVelocity);
+        }
+    }
 }
 
 void PhysicsBody::onEnter()
@@ -376,6 +376,17 @@ public:
      * A dynamic body will effect with gravity.
      */
     void setDynamic(bool dynamic);
+
+    /** Test the body is static or not. */
+    inline bool isStatic() const { return _static; }
+    /**
+     * @brief Set static to body.
+     *
+     * A static body is not dynamic and, unlike kinematic one, lets bodies resting on it fall asleep.
+     * It is not expected to move, its shapes are not reindexed on setPosition()/setRotation().
+     * setDynamic(true) makes it dynamic, setStatic(false) makes it kinematic.
+     */
+    void setStatic(bool isStatic);
     
     /**
      * @brief Set the body mass.
@@ -479,6 +490,9 @@ public:
     inline void setUpdateVelocityFunc(UpdateVelocityFunc func) { _updateVelocityFunc = func; }
     inline void resetUpdateVelocityFunc() { _updateVelocityFunc = UpdateVelocityFunc(); }
 
+    /** Gravity of world's force field at body position, evaluated for all awake bodies at once before every step. */
+    inline const Vec2& getFieldGravity() const { return _fieldGravity; }
+
     /** Convert the world point to local. */
     Vec2 world2Local(const Vec2& point);
     
@@ -515,7 +529,17 @@ protected:
     void removeFromPhysicsWorld();
 
     void beforeSimulation(const Mat4& parentToWorldTransform, const Mat4& nodeToWorldTransform, float scaleX, float scaleY, float rotation);
-    void afterSimulation(const Mat4& parentToWorldTransform, float parentRotation);
+    void afterSimulation(const Mat4& parentToWorldTransform, float parentRotation, float alpha);
+    // Remember current state as previous one for interpolation, called before the last step of update
+    void saveInterpolationState();
+    // Whether owner transform differs from the one of the last sync, i.e. was changed by user
+    bool isOwnerChanged() const;
+    void recordOwnerState();
+    // Queues owner check by the next PhysicsWorld::beforeSimulation(), called by owner transform setters
+    void markOwnerChanged();
+    // Applies field gravity before step. Body without custom velocity func and limits gets it as force
+    // integrated by default chipmunk routine, per-body callback is used only for the rest ones
+    void applyFieldGravity(float gx, float gy, bool worldGravity);
 protected:
     std::vector<PhysicsJoint*> _joints;
     Vector<PhysicsShape*> _shapes;
@@ -523,6 +547,7 @@ protected:
     
     cpBody* _cpBody;
     bool _dynamic;
+    bool _static;
     bool _rotationEnabled;
     bool _gravityEnabled;
     bool _massDefault;
@@ -559,11 +584,30 @@ protected:
     float _recordPosX;
     float _recordPosY;
 
+    // State before the last step, node transform is interpolated between it and the current one
+    Vec2 _prevPosition;
+    double _prevAngle;
+    // World transform set to owner by the last afterSimulation(), owner changed by user differs from it
+    bool _rendered;
+    float _renderPosX;
+    float _renderPosY;
+    float _renderRotation;
+    // Local transform of owner after the last sync
+    float _ownerPosX;
+    float _ownerPosY;
+    float _ownerRotation;
+    float _ownerScaleX;
+    float _ownerScaleY;
+    unsigned int _syncStamp; // Stamp of the last PhysicsWorld::afterSimulation() this body was synced by
+    bool _ownerMarked; // Already queued for owner check
+
     UpdateVelocityFunc _updateVelocityFunc;
+    Vec2 _fieldGravity;
 
     friend class PhysicsWorld;
     friend class PhysicsShape;
     friend class PhysicsJoint;
+    friend class Node;
 };
 
 /** @} */
@@ -5,6 +5,8 @@
 #include "physics/CCPhysicsBody.h"
 #include "physics/CCPhysicsWorld.h"
 
+#include <algorithm>
+
 NS_CC_BEGIN
 
 PhysicsForceField::PhysicsForceField()
@@ -59,6 +61,30 @@ Vec2 PhysicsForceField::getGravity(Vec2 p)
     return Vec2(res.x, res.y);
 }
 
+void PhysicsForceField::getGravity(size_t count, const cpFloat* x, const cpFloat* y, cpFloat* gx, cpFloat* gy)
+{
+    std::fill(gx, gx + count, 0.0f);
+    std::fill(gy, gy + count, 0.0f);
+    const cpFloat minDistanceSq = _minDistanceSq;
+    for (auto bm : _gravitySources) {
+        const cpVect s = cpBodyGetPosition(bm.first->getCPBody());
+        const cpFloat mass = bm.second;
+        for (size_t i = 0; i < count; i++) {
+            cpFloat dx = s.x - x[i];
+            cpFloat dy = s.y - y[i];
+            cpFloat dlensq = dx*dx + dy*dy;
+            cpFloat k = (dlensq >= minDistanceSq? mass / (dlensq*cpfsqrt(dlensq)): 0.0f);
+            gx[i] += dx*k;
+            gy[i] += dy*k;
+        }
+    }
+    const cpFloat g = _gravityConstant;
+    for (size_t i = 0; i < count; i++) {
+        gx[i] *= g;
+        gy[i] *= g;
+    }
+}
+
 //cpVect PhysicsForceField::getBodyGravity(PhysicsBody* body, cpVect p)
 //{
 //    cpVect ret = cpvzero;
@@ -26,6 +26,9 @@ public:
 
     cpVect getGravity(cpVect p);
     Vec2 getGravity(Vec2 p);
+    // Gravity at count points given by separate coordinate arrays, result is written to gx and gy.
+    // Points are iterated in inner loop without branches, so that compiler is able to vectorize it
+    void getGravity(size_t count, const cpFloat* x, const cpFloat* y, cpFloat* gx, cpFloat* gy);
 //    cpVect getBodyGravity(PhysicsBody* body, cpVect p);
 //    Vec2 getBodyGravity(PhysicsBody* body, Vec2 p);
 
@@ -41,6 +41,7 @@
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
+#include "base/CCEventListenerCustom.h"
 
 NS_CC_BEGIN
 const float PHYSICS_INFINITY = FLT_MAX;
@@ -127,7 +128,22 @@ void PhysicsWorldCallback::collisionSeparateCallbackFunc(cpArbiter *arb, cpSpace
     
     world->collisionSeparateCallback(*contact);
     
-    delete contact;
+    if (world->isStepThread())
+    {
+        // arbiter could be reused by the time deferred events are dispatched,
+        // contact is deleted after deferred separate event is dispatched
+        contact->_contactInfo = nullptr;
+    }
+    else if (world->_dispatchingDeferred)
+    {
+        // contact could still be referenced by deferred events, which are skipped for disabled contacts
+        contact->setNotificationEnable(false);
+        world->_separatedContacts.push_back(contact);
+    }
+    else
+    {
+        delete contact;
+    }
 }
 
 void PhysicsWorldCallback::rayCastCallbackFunc(cpShape *shape, cpVect point, cpVect normal, cpFloat alpha, RayCastCallbackInfo *info)
@@ -350,6 +366,16 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     
     if (contact.isNotificationEnabled())
     {
+        if (isStepThread())
+        {
+            // listeners are not thread-safe, so decision is made by filter and notification is deferred
+            if (ret && _contactFilter)
+            {
+                ret = _contactFilter(contact);
+            }
+            deferContact(contact, PhysicsContact::EventCode::BEGIN);
+            return ret;
+        }
         contact.setEventCode(PhysicsContact::EventCode::BEGIN);
         contact.setWorld(this);
         _eventDispatcher->dispatchEvent(&contact);
@@ -364,6 +390,11 @@ bool PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
     {
         return true;
     }
+
+    if (isStepThread())
+    {
+        return true; // pre-solve listeners are not called with async step
+    }
     
     contact.setEventCode(PhysicsContact::EventCode::PRESOLVE);
     contact.setWorld(this);
@@ -378,6 +409,12 @@ void PhysicsWorld::collisionPostSolveCallback(PhysicsContact& contact)
     {
         return;
     }
+
+    if (isStepThread())
+    {
+        deferContact(contact, PhysicsContact::EventCode::POSTSOLVE);
+        return;
+    }
     
     contact.setEventCode(PhysicsContact::EventCode::POSTSOLVE);
     contact.setWorld(this);
@@ -390,6 +427,12 @@ void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
     {
         return;
     }
+
+    if (isStepThread())
+    {
+        deferContact(contact, PhysicsContact::EventCode::SEPARATE);
+        return;
+    }
     
     contact.setEventCode(PhysicsContact::EventCode::SEPARATE);
     contact.setWorld(this);
@@ -462,6 +505,163 @@ void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& po
     }
 }
 
+void PhysicsWorld::queryPoints(size_t count, const Vec2* points, const float* maxDistances, const int* masks,
+                               std::vector<int>& offsets, std::vector<PhysicsShape*>& shapes)
+{
+    queryBatch(count, points, maxDistances, nullptr, masks, offsets, shapes);
+}
+
+void PhysicsWorld::queryRects(size_t count, const Rect* rects, const int* masks,
+                              std::vector<int>& offsets, std::vector<PhysicsShape*>& shapes)
+{
+    queryBatch(count, nullptr, nullptr, rects, masks, offsets, shapes);
+}
+
+namespace
+{
+    // Spreads lower 16 bits of x to even bits
+    inline uint32_t mortonSpread(uint32_t x)
+    {
+        x &= 0xffff;
+        x = (x | (x << 8)) & 0x00ff00ff;
+        x = (x | (x << 4)) & 0x0f0f0f0f;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    }
+
+    cpCollisionID batchCandidateFunc(void* obj, void* shape, cpCollisionID id, void* data)
+    {
+        static_cast<std::vector<void*>*>(data)->push_back(shape);
+        return id;
+    }
+
+    const size_t BATCH_MAX_CLUSTER = 32;
+}
+
+void PhysicsWorld::queryBatch(size_t count, const Vec2* points, const float* maxDistances, const Rect* rects, const int* masks,
+                              std::vector<int>& offsets, std::vector<PhysicsShape*>& shapes)
+{
+    offsets.assign(count + 1, 0);
+    shapes.clear();
+    if (count == 0)
+    {
+        return;
+    }
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    // Bounding box of every query and bounds of them all
+    _batchBounds.resize(count);
+    Rect all;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (points)
+        {
+            float r = maxDistances ? std::max(maxDistances[i], 0.0f) : 0.0f;
+            _batchBounds[i].setRect(points[i].x - r, points[i].y - r, 2 * r, 2 * r);
+        }
+        else
+        {
+            _batchBounds[i] = rects[i];
+        }
+        all = (i == 0 ? _batchBounds[i] : all.unionWithRect(_batchBounds[i]));
+    }
+
+    // Sort queries along Z-order curve through their centers, so that neighbours in order are close in space
+    _batchOrder.resize(count);
+    float scaleX = all.size.width > 0.0f ? 65535.0f / all.size.width : 0.0f;
+    float scaleY = all.size.height > 0.0f ? 65535.0f / all.size.height : 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t x = (uint32_t)((_batchBounds[i].getMidX() - all.origin.x) * scaleX);
+        uint32_t y = (uint32_t)((_batchBounds[i].getMidY() - all.origin.y) * scaleY);
+        uint64_t code = mortonSpread(x) | (mortonSpread(y) << 1);
+        _batchOrder[i] = (code << 32) | i;
+    }
+    std::sort(_batchOrder.begin(), _batchOrder.end());
+
+    // Consecutive queries are joined into cluster while its box is not much larger than their own boxes.
+    // Spatial index is traversed once per cluster and candidates are tested against each query of cluster
+    _batchFound.clear();
+    for (size_t first = 0; first < count; )
+    {
+        size_t i0 = (size_t)(_batchOrder[first] & 0xffffffff);
+        cpBB clusterBB = PhysicsHelper::rect2cpbb(_batchBounds[i0]);
+        cpFloat areaSum = cpBBArea(clusterBB);
+        size_t last = first + 1;
+        for (; last < count && last - first < BATCH_MAX_CLUSTER; ++last)
+        {
+            size_t i = (size_t)(_batchOrder[last] & 0xffffffff);
+            cpBB bb = PhysicsHelper::rect2cpbb(_batchBounds[i]);
+            if (!cpBBContainsBB(clusterBB, bb) && cpBBMergedArea(clusterBB, bb) > 2 * (areaSum + cpBBArea(bb)))
+            {
+                break;
+            }
+            clusterBB = cpBBMerge(clusterBB, bb);
+            areaSum += cpBBArea(bb);
+        }
+
+        _batchCandidates.clear();
+        cpSpatialIndexQuery(_cpSpace->staticShapes, &clusterBB, clusterBB, batchCandidateFunc, &_batchCandidates);
+        cpSpatialIndexQuery(_cpSpace->dynamicShapes, &clusterBB, clusterBB, batchCandidateFunc, &_batchCandidates);
+
+        for (size_t k = first; k < last; ++k)
+        {
+            size_t i = (size_t)(_batchOrder[k] & 0xffffffff);
+            cpBB bb = PhysicsHelper::rect2cpbb(_batchBounds[i]);
+            for (void* candidate : _batchCandidates)
+            {
+                cpShape* shape = static_cast<cpShape*>(candidate);
+                if (!cpBBIntersects(bb, shape->bb))
+                {
+                    continue;
+                }
+                PhysicsShape* physicsShape = static_cast<PhysicsShape*>(cpShapeGetUserData(shape));
+                if (masks && (physicsShape->getCategoryBitmask() & masks[i]) == 0)
+                {
+                    continue;
+                }
+                if (points)
+                {
+                    // The same test as cpSpacePointQuery() does
+                    cpPointQueryInfo info;
+                    cpShapePointQuery(shape, PhysicsHelper::point2cpv(points[i]), &info);
+                    if (!info.shape || info.distance >= (maxDistances ? maxDistances[i] : 0.0f))
+                    {
+                        continue;
+                    }
+                }
+                _batchFound.emplace_back((int)i, physicsShape);
+            }
+        }
+        first = last;
+    }
+
+    // Group found shapes by query
+    for (auto& found : _batchFound)
+    {
+        ++offsets[found.first + 1];
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+    shapes.resize(_batchFound.size());
+    for (auto& found : _batchFound)
+    {
+        // offsets[i] is used as cursor and ends up pointing to the end of i-th group
+        shapes[offsets[found.first]++] = found.second;
+    }
+    for (size_t i = count; i > 0; --i)
+    {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
+}
+
 Vector<PhysicsShape*> PhysicsWorld::getShapes(const Vec2& point) const
 {
     Vector<PhysicsShape*> arr;
@@ -529,6 +729,8 @@ void PhysicsWorld::addBody(PhysicsBody* body)
     addBodyOrDelay(body);
     _bodies.pushBack(body);
     body->_world = this;
+    markBodyMoved(body);
+    body->markOwnerChanged();
 }
 
 void PhysicsWorld::doAddBody(PhysicsBody* body)
@@ -617,6 +819,9 @@ void PhysicsWorld::removeBody(PhysicsBody* body)
     
     removeBodyOrDelay(body);
     _bodies.eraseObject(body);
+    _syncBodies.erase(std::remove(_syncBodies.begin(), _syncBodies.end(), body), _syncBodies.end());
+    _ownerBodies.erase(std::remove(_ownerBodies.begin(), _ownerBodies.end(), body), _ownerBodies.end());
+    body->_ownerMarked = false;
     body->_world = nullptr;
 }
 
@@ -810,6 +1015,12 @@ void PhysicsWorld::removeAllBodies()
     }
     
     _bodies.clear();
+    _syncBodies.clear();
+    for (auto& body : _ownerBodies)
+    {
+        body->_ownerMarked = false;
+    }
+    _ownerBodies.clear();
 }
 
 void PhysicsWorld::setDebugDrawMask(int mask, unsigned short cameraMask)
@@ -855,6 +1066,26 @@ void PhysicsWorld::setGravity(const Vec2& gravity)
     cpSpaceSetGravity(_cpSpace, PhysicsHelper::point2cpv(gravity));
 }
 
+void PhysicsWorld::setSleepTimeThreshold(float time)
+{
+    cpSpaceSetSleepTimeThreshold(_cpSpace, time);
+}
+
+float PhysicsWorld::getSleepTimeThreshold() const
+{
+    return cpSpaceGetSleepTimeThreshold(_cpSpace);
+}
+
+void PhysicsWorld::setIdleSpeedThreshold(float speed)
+{
+    cpSpaceSetIdleSpeedThreshold(_cpSpace, speed);
+}
+
+float PhysicsWorld::getIdleSpeedThreshold() const
+{
+    return cpSpaceGetIdleSpeedThreshold(_cpSpace);
+}
+
 void PhysicsWorld::setSubsteps(int steps)
 {
     if(steps > 0)
@@ -879,8 +1110,253 @@ void PhysicsWorld::step(float delta)
     }
 }
 
+void PhysicsWorld::simulateFixedSteps(int steps, float dt)
+{
+    // when world runs faster than real time, fixed step is split to keep solver step not longer than at normal speed,
+    // with integer speed solver steps are exactly the ones done at normal speed
+    int substeps;
+    float subDt;
+    if (_speed >= 1.0f && _speed == floorf(_speed))
+    {
+        substeps = _substeps * (int)_speed;
+        subDt = 1.0f / _fixedRate / _substeps;
+    }
+    else
+    {
+        substeps = std::max(_substeps, (int)ceilf(_speed - 1e-3f));
+        subDt = dt / substeps;
+    }
+    for (int i = 0; i < steps; ++i)
+    {
+        if (_interpolation && i == steps - 1)
+        {
+            // Only awake bodies move during the step, the rest keep state saved when they were teleported
+            // or stepped last time. Sleeping ones are not in the array
+            cpArray* bodies = _cpSpace->dynamicBodies;
+            for (int k = 0; k < bodies->num; ++k)
+            {
+                static_cast<PhysicsBody*>(cpBodyGetUserData(static_cast<cpBody*>(bodies->arr[k])))->saveInterpolationState();
+            }
+        }
+        for (int j = 0; j < substeps; ++j)
+        {
+            stepSpace(subDt);
+        }
+    }
+}
+
+void PhysicsWorld::stepSpace(float dt)
+{
+    applyForceField();
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    cpSpaceStep(_cpSpace, dt);
+#else
+    cpHastySpaceStep(_cpSpace, dt);
+#endif
+}
+
+void PhysicsWorld::applyForceField()
+{
+    // Gather awake dynamic bodies, sleeping ones are not in the array and are not integrated anyway.
+    // Body woken up during the step gets no field gravity for that step, it was at rest before
+    cpArray* bodies = _cpSpace->dynamicBodies;
+    _fieldBodies.clear();
+    _fieldX.clear();
+    _fieldY.clear();
+    for (int i = 0; i < bodies->num; ++i)
+    {
+        cpBody* body = static_cast<cpBody*>(bodies->arr[i]);
+        if (cpBodyGetType(body) != CP_BODY_TYPE_DYNAMIC)
+        {
+            continue;
+        }
+        _fieldBodies.push_back(static_cast<PhysicsBody*>(cpBodyGetUserData(body)));
+        _fieldX.push_back(body->p.x);
+        _fieldY.push_back(body->p.y);
+    }
+
+    size_t count = _fieldBodies.size();
+    _fieldGX.resize(count);
+    _fieldGY.resize(count);
+    if (_forceField)
+    {
+        _forceField->getGravity(count, _fieldX.data(), _fieldY.data(), _fieldGX.data(), _fieldGY.data());
+    }
+    else
+    {
+        std::fill(_fieldGX.begin(), _fieldGX.end(), 0.0f);
+        std::fill(_fieldGY.begin(), _fieldGY.end(), 0.0f);
+    }
+
+    bool worldGravity = cpvlengthsq(cpSpaceGetGravity(_cpSpace)) > 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        _fieldBodies[i]->applyFieldGravity(_fieldGX[i], _fieldGY[i], worldGravity);
+    }
+}
+
+void PhysicsWorld::setAsyncStep(bool async)
+{
+    if (async == _asyncStep)
+    {
+        return;
+    }
+    if (async)
+    {
+        _stepExit = false;
+        _stepThread = std::thread(&PhysicsWorld::stepThreadLoop, this);
+        // game logic scheduled by director should see results of the steps
+        _beforeUpdateListener = _eventDispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*) {
+            finishStep();
+        });
+    }
+    else
+    {
+        finishStep();
+        stopStepThread();
+        _eventDispatcher->removeEventListener(_beforeUpdateListener);
+        _beforeUpdateListener = nullptr;
+    }
+    _asyncStep = async;
+}
+
+void PhysicsWorld::stopStepThread()
+{
+    {
+        // thread exits after the current job is done
+        std::lock_guard<std::mutex> lock(_stepMutex);
+        _stepExit = true;
+        _stepCondition.notify_all();
+    }
+    _stepThread.join();
+}
+
+void PhysicsWorld::stepThreadLoop()
+{
+    std::unique_lock<std::mutex> lock(_stepMutex);
+    while (true)
+    {
+        _stepCondition.wait(lock, [this] { return _stepJob > 0 || _stepExit; });
+        if (_stepJob == 0)
+        {
+            return; // exit requested
+        }
+        int steps = _stepJob;
+        float dt = _stepJobDt;
+        lock.unlock();
+        simulateFixedSteps(steps, dt);
+        lock.lock();
+        _stepJob = 0;
+        _stepCondition.notify_all();
+    }
+}
+
+bool PhysicsWorld::isStepThread() const
+{
+    return _asyncStep && std::this_thread::get_id() == _stepThread.get_id();
+}
+
+void PhysicsWorld::finishStep()
+{
+    if (!_stepStarted)
+    {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(_stepMutex);
+        _stepCondition.wait(lock, [this] { return _stepJob == 0; });
+    }
+    _stepStarted = false;
+
+    dispatchDeferredContacts();
+
+    if (_debugDrawMask != DEBUGDRAW_NONE)
+    {
+        debugDraw();
+    }
+    afterSimulation();
+}
+
+void PhysicsWorld::deferContact(PhysicsContact& contact, PhysicsContact::EventCode code)
+{
+    if (code == PhysicsContact::EventCode::POSTSOLVE)
+    {
+        // contact is solved every step, but listeners are notified only once per update
+        if (!_deferredPostSolve.insert(&contact).second)
+        {
+            return;
+        }
+    }
+    _deferredContacts.push_back({&contact, code});
+}
+
+void PhysicsWorld::dispatchDeferredContacts()
+{
+    if (_deferredContacts.empty())
+    {
+        return;
+    }
+
+    // listeners could destroy nodes, keep everything referenced by contacts alive until all are dispatched
+    Vector<Ref*> keep;
+    for (auto& deferred : _deferredContacts)
+    {
+        for (PhysicsShape* shape : {deferred.contact->getShapeA(), deferred.contact->getShapeB()})
+        {
+            keep.pushBack(shape);
+            if (PhysicsBody* body = shape->getBody())
+            {
+                keep.pushBack(body);
+                if (Node* node = body->getNode())
+                {
+                    keep.pushBack(node);
+                }
+            }
+        }
+    }
+
+    _dispatchingDeferred = true;
+    std::vector<DeferredContact> contacts;
+    contacts.swap(_deferredContacts);
+    _deferredPostSolve.clear();
+    for (auto& deferred : contacts)
+    {
+        PhysicsContact* contact = deferred.contact;
+        if (deferred.code == PhysicsContact::EventCode::POSTSOLVE && !contact->_contactInfo)
+        {
+            // separated later in the same step, arbiter that post-solve data is read from is gone
+        }
+        else if (contact->isNotificationEnabled())
+        {
+            contact->setEventCode(deferred.code);
+            contact->setWorld(this);
+            _eventDispatcher->dispatchEvent(contact);
+            bool accepted = contact->resetResult();
+            if (deferred.code == PhysicsContact::EventCode::BEGIN && !accepted && contact->_contactInfo)
+            {
+                // filter accepted contact during step, but listener rejected it: ignore arbiter
+                // until separation, as it would be if begin callback returned false
+                cpArbiterIgnore(static_cast<cpArbiter*>(contact->_contactInfo));
+            }
+        }
+        if (deferred.code == PhysicsContact::EventCode::SEPARATE)
+        {
+            delete contact;
+        }
+    }
+    _dispatchingDeferred = false;
+
+    for (PhysicsContact* contact : _separatedContacts)
+    {
+        delete contact;
+    }
+    _separatedContacts.clear();
+}
+
 void PhysicsWorld::update(float delta, bool userCall/* = false*/)
 {
+    finishStep();
+
     if(!_delayAddBodies.empty())
     {
         updateBodies();
@@ -890,8 +1366,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         updateBodies();
     }
     
-    auto sceneToWorldTransform = _scene->getNodeToParentTransform();
-    beforeSimulation(_scene, sceneToWorldTransform, 1.f, 1.f, 0.f);
+    beforeSimulation();
 
     if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
     {
@@ -905,11 +1380,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
     
     if (userCall)
     {
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-		cpSpaceStep(_cpSpace, delta);
-#else
-		cpHastySpaceStep(_cpSpace, delta);
-#endif
+        stepSpace(delta);
     }
     else
     {
@@ -918,15 +1389,29 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         {
             const float step = 1.0f / _fixedRate;
             const float dt = step * _speed;
-            while(_updateTime>step)
+            int steps = (int)(_updateTime / step);
+            if (_maxFixedSteps && steps > _maxFixedSteps)
             {
-                _updateTime-=step;
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-				cpSpaceStep(_cpSpace, dt);
-#else
-				cpHastySpaceStep(_cpSpace, dt);
-#endif
-			}
+                // drop time we are not able to catch up with
+                _updateTime = fmodf(_updateTime, step) + step * _maxFixedSteps;
+                steps = _maxFixedSteps;
+            }
+            _updateTime -= step * steps;
+            if (_interpolation)
+            {
+                _interpolationAlpha = std::min(1.0f, std::max(0.0f, _updateTime / step));
+            }
+            if (_asyncStep && steps > 0)
+            {
+                // steps are done concurrently with rendering, results are taken by finishStep()
+                std::lock_guard<std::mutex> lock(_stepMutex);
+                _stepJob = steps;
+                _stepJobDt = dt;
+                _stepStarted = true;
+                _stepCondition.notify_all();
+                return;
+            }
+            simulateFixedSteps(steps, dt);
         }
         else
         {
@@ -935,15 +1420,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
                 const float dt = _updateTime * _speed / _substeps;
                 for (int i = 0; i < _substeps; ++i)
                 {
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-					cpSpaceStep(_cpSpace, dt);
-#else
-					cpHastySpaceStep(_cpSpace, dt);
-#endif 
-					for (auto& body : _bodies)
-                    {
-                        body->update(dt);
-                    }
+                    stepSpace(dt);
                 }
                 _updateRateCount = 0;
                 _updateTime = 0.0f;
@@ -956,9 +1433,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         debugDraw();
     }
 
-    // Update physics position, should loop as the same sequence as node tree.
-    // PhysicsWorld::afterSimulation() will depend on the sequence.
-    afterSimulation(_scene, sceneToWorldTransform, 0.f);
+    afterSimulation();
 }
 
 PhysicsWorld* PhysicsWorld::construct(Scene* scene)
@@ -983,8 +1458,20 @@ PhysicsWorld::PhysicsWorld()
 , _updateTime(0.0f)
 , _substeps(1)
 , _fixedRate(0)
+, _maxFixedSteps(0)
+, _interpolation(false)
+, _interpolationAlpha(1.0f)
+, _asyncStep(false)
+, _stepJob(0)
+, _stepJobDt(0.0f)
+, _stepExit(false)
+, _stepStarted(false)
+, _dispatchingDeferred(false)
+, _beforeUpdateListener(nullptr)
 , _cpSpace(nullptr)
 , _updateBodyTransform(false)
+, _syncStamp(0)
+, _syncingNodes(false)
 , _scene(nullptr)
 , _autoStep(true)
 , _debugDraw(nullptr)
@@ -997,6 +1484,20 @@ PhysicsWorld::PhysicsWorld()
 
 PhysicsWorld::~PhysicsWorld()
 {
+    if (_asyncStep)
+    {
+        stopStepThread();
+        for (auto& deferred : _deferredContacts)
+        {
+            if (deferred.code == PhysicsContact::EventCode::SEPARATE)
+            {
+                delete deferred.contact;
+            }
+        }
+        _deferredContacts.clear();
+        _eventDispatcher->removeEventListener(_beforeUpdateListener);
+        _asyncStep = false;
+    }
     removeAllJoints(true);
     removeAllBodies();
     if (_cpSpace)
@@ -1010,37 +1511,93 @@ PhysicsWorld::~PhysicsWorld()
     CC_SAFE_RELEASE_NULL(_debugDraw);
 }
 
-void PhysicsWorld::beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation)
+// Transform of node parents accumulated the same way as by walking scene graph from root
+static void getParentTransform(Node* node, Mat4& parentToWorldTransform, float& scaleX, float& scaleY, float& rotation)
 {
-    auto scaleX = nodeParentScaleX * node->getScaleX();
-    auto scaleY = nodeParentScaleY * node->getScaleY();
-    auto rotation = parentRotation + node->getRotation();
+    Node* parent = node->getParent();
+    parentToWorldTransform = (parent? parent->getNodeToWorldTransform(): Mat4::IDENTITY);
+    scaleX = scaleY = 1.f;
+    rotation = 0.f;
+    for (; parent; parent = parent->getParent())
+    {
+        scaleX *= parent->getScaleX();
+        scaleY *= parent->getScaleY();
+        rotation += parent->getRotation();
+    }
+}
 
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
+void PhysicsWorld::beforeSimulation()
+{
+    // Only bodies marked since the last sync are visited: added, enabled or having owner transform set by user.
+    // Node is pushed to body only if it was changed by user since the last sync
+    Mat4 parentToWorldTransform;
+    float scaleX, scaleY, parentRotation;
+    std::swap(_ownerBodies, _checkedOwnerBodies);
+    for (auto& body : _checkedOwnerBodies)
+    {
+        body->_ownerMarked = false;
+        Node* node = body->getNode();
+        if (body->getWorld() != this || !node || !body->isOwnerChanged())
+        {
+            continue;
+        }
+        getParentTransform(node, parentToWorldTransform, scaleX, scaleY, parentRotation);
+        auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
+        body->beforeSimulation(parentToWorldTransform, nodeToWorldTransform,
+            scaleX * node->getScaleX(), scaleY * node->getScaleY(), parentRotation + node->getRotation());
+        markBodyMoved(body);
+    }
+    _checkedOwnerBodies.clear();
+}
 
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+void PhysicsWorld::afterSimulation()
+{
+    // Only awake bodies are moved by the step. Static, sleeping and resting kinematic ones are synced
+    // only when marked: added, changed by user or awake last time, because they may fall asleep since then
+    // Owner changes made by the sync itself are not user ones and are not marked
+    _syncingNodes = true;
+    ++_syncStamp;
+    std::swap(_syncBodies, _syncedBodies);
+    _syncBodies.clear();
+    cpArray* bodies = _cpSpace->dynamicBodies;
+    for (int i = 0; i < bodies->num; ++i)
+    {
+        cpBody* body = static_cast<cpBody*>(bodies->arr[i]);
+        if (cpBodyGetType(body) == CP_BODY_TYPE_KINEMATIC && cpvlengthsq(body->v) == 0.0f && body->w == 0.0f)
+        {
+            continue;
+        }
+        PhysicsBody* physicsBody = static_cast<PhysicsBody*>(cpBodyGetUserData(body));
+        afterSimulation(physicsBody);
+        _syncBodies.push_back(physicsBody);
+    }
+    for (auto& body : _syncedBodies)
     {
-        physicsBody->beforeSimulation(parentToWorldTransform, nodeToWorldTransform, scaleX, scaleY, rotation);
+        afterSimulation(body);
     }
-
-    for (auto child : node->getChildren())
-        beforeSimulation(child, nodeToWorldTransform, scaleX, scaleY, rotation);
+    _syncedBodies.clear();
+    _syncingNodes = false;
 }
 
-void PhysicsWorld::afterSimulation(Node *node, const Mat4& parentToWorldTransform, float parentRotation)
+void PhysicsWorld::afterSimulation(PhysicsBody* body)
 {
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
-    auto nodeRotation = parentRotation + node->getRotation();
-
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+    Node* node = body->getNode();
+    if (body->_syncStamp == _syncStamp || body->getWorld() != this || !node)
     {
-        physicsBody->afterSimulation(parentToWorldTransform, parentRotation);
+        return; // Already synced or removed body waiting for delayed removal from space
     }
+    body->_syncStamp = _syncStamp;
+    Mat4 parentToWorldTransform;
+    float scaleX, scaleY, parentRotation;
+    getParentTransform(node, parentToWorldTransform, scaleX, scaleY, parentRotation);
+    // Body fallen asleep in an earlier step of the update has stale interpolation state, show its final one
+    float alpha = cpBodyIsSleeping(body->_cpBody) ? 1.0f : _interpolationAlpha;
+    body->afterSimulation(parentToWorldTransform, parentRotation, alpha);
+}
 
-    for (auto child : node->getChildren())
-        afterSimulation(child, nodeToWorldTransform, nodeRotation);
+void PhysicsWorld::markBodyMoved(PhysicsBody* body)
+{
+    _syncBodies.push_back(body);
 }
 
 NS_CC_END
@@ -29,10 +29,16 @@
 #if CC_USE_PHYSICS
 
 #include <list>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 #include "base/CCVector.h"
 #include "base/CCRefPtr.h"
 #include "math/CCGeometry.h"
 #include "physics/CCPhysicsBody.h"
+#include "physics/CCPhysicsContact.h"
 #include "physics/CCPhysicsForceField.h"
 
 struct cpSpace;
@@ -190,6 +196,29 @@ public:
     * @param   data   User defined data, it is passed to func. 
     */
     void queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, void* data, float maxDistance = 0.0f);
+
+    /**
+    * Searches for physics shapes near many points in one call.
+    *
+    * Queries are sorted along Z-order curve and nearby queries share single traversal of spatial index.
+    * Shapes found by i-th query are shapes[offsets[i]] ... shapes[offsets[i + 1] - 1].
+    * @param   count   Number of queries.
+    * @param   points   Query points.
+    * @param   maxDistances   Max distance from i-th point to shape. If nullptr, only shapes containing points are found.
+    * @param   masks   Only shapes with category bitmask intersecting masks[i] are found by i-th query. If nullptr, all shapes are found.
+    * @param   offsets   Output offsets into shapes, count + 1 elements.
+    * @param   shapes   Output shapes found by all queries.
+    */
+    void queryPoints(size_t count, const Vec2* points, const float* maxDistances, const int* masks,
+                     std::vector<int>& offsets, std::vector<PhysicsShape*>& shapes);
+
+    /**
+    * Searches for physics shapes whose bounding boxes overlap many rects in one call.
+    *
+    * The same as queryPoints(), but i-th query finds shapes overlapping rects[i] like queryRect() does.
+    */
+    void queryRects(size_t count, const Rect* rects, const int* masks,
+                    std::vector<int>& offsets, std::vector<PhysicsShape*>& shapes);
     
     /**
     * Get physics shapes that contains the point. 
@@ -251,6 +280,8 @@ public:
      * Set the speed of this physics world.
      *
      * @attention if you setAutoStep(false), this won't work.
+     * With fixed step system every step is divided into at least ceil(speed) substeps, so speeding up does not hurt accuracy.
+     * Integer speed gives exactly the same solver steps as normal speed does.
      * @param speed  A float number. Speed is the rate at which the simulation executes. default value is 1.0.
      */
     inline void setSpeed(float speed) { if(speed >= 0.0f) { _speed = speed; } }
@@ -304,6 +335,65 @@ public:
     /** get the number of substeps */
     inline int getFixedUpdateRate() const { return _fixedRate; }
 
+    /**
+     * set the maximum number of fixed steps in one update of the physics world.
+     * Time that cannot be simulated in this number of steps is dropped, so slow frame does not make next frames even slower.
+     * 0 - no limit
+     * default value is 0
+     */
+    void setMaxFixedSteps(int steps) { if(steps >= 0) { _maxFixedSteps = steps; } }
+    /** get the maximum number of fixed steps in one update */
+    inline int getMaxFixedSteps() const { return _maxFixedSteps; }
+
+    /**
+     * enable interpolation of node transforms between two last fixed steps.
+     * Nodes are shown up to one step behind the simulation, but move smoothly when frame rate differs from fixed update rate.
+     * Works only with fixed step system, default value is false
+     */
+    void setInterpolation(bool enable) { _interpolation = enable; _interpolationAlpha = 1.0f; }
+    inline bool isInterpolation() const { return _interpolation; }
+    /** get part of fixed step elapsed since the last simulated state, nodes are interpolated by this value */
+    inline float getInterpolationAlpha() const { return _interpolationAlpha; }
+
+    /**
+     * do fixed steps on separate thread concurrently with rendering.
+     * Steps started by update are finished before the next scheduler update, so nodes show state one frame behind.
+     * Contact listeners are not thread-safe, so during the step begin, post-solve (once per update) and separate
+     * events are recorded and dispatched on the main thread by finishStep(). Pre-solve events are not dispatched.
+     * Works only with fixed step system, default value is false
+     */
+    void setAsyncStep(bool async);
+    inline bool isAsyncStep() const { return _asyncStep; }
+
+    /**
+     * set thread-safe function that decides whether a new contact is processed by solver during async step.
+     * Begin listeners are called after the step, if they reject accepted contact, it is ignored from then on.
+     */
+    void setContactFilter(const std::function<bool(PhysicsContact&)>& filter) { _contactFilter = filter; }
+
+    /** wait for async step to finish, dispatch deferred contact events and update nodes */
+    void finishStep();
+
+    /**
+     * Set the time a group of bodies must remain idle in order to fall asleep.
+     *
+     * @param time A float number in seconds, default value is infinity (sleeping is disabled).
+     */
+    void setSleepTimeThreshold(float time);
+
+    /** Get the time a group of bodies must remain idle in order to fall asleep. */
+    float getSleepTimeThreshold() const;
+
+    /**
+     * Set the speed threshold for a body to be considered idle.
+     *
+     * @param speed A float number, default value is 0 (estimated from gravity, which is wrong for force fields).
+     */
+    void setIdleSpeedThreshold(float speed);
+
+    /** Get the speed threshold for a body to be considered idle. */
+    float getIdleSpeedThreshold() const;
+
     /**
     * Set the debug draw mask of this physics world.
     * 
@@ -374,6 +464,17 @@ protected:
     virtual void removeBodyOrDelay(PhysicsBody* body);
     virtual void updateBodies();
     virtual void updateJoints();
+
+    void simulateFixedSteps(int steps, float dt);
+    void stepSpace(float dt);
+    void applyForceField();
+    void queryBatch(size_t count, const Vec2* points, const float* maxDistances, const Rect* rects, const int* masks,
+                    std::vector<int>& offsets, std::vector<PhysicsShape*>& shapes);
+    void stepThreadLoop();
+    void stopStepThread();
+    bool isStepThread() const;
+    void deferContact(PhysicsContact& contact, PhysicsContact::EventCode code);
+    void dispatchDeferredContacts();
     
 protected:
     Vec2 _gravity;
@@ -383,12 +484,52 @@ protected:
     float _updateTime;
     int _substeps;
     int _fixedRate;
+    int _maxFixedSteps;
+    bool _interpolation;
+    float _interpolationAlpha;
     cpSpace* _cpSpace;
+
+    struct DeferredContact
+    {
+        PhysicsContact* contact;
+        PhysicsContact::EventCode code;
+    };
+    bool _asyncStep;
+    std::thread _stepThread;
+    std::mutex _stepMutex;
+    std::condition_variable _stepCondition;
+    int _stepJob; // number of steps requested from step thread, zero when it is idle
+    float _stepJobDt;
+    bool _stepExit;
+    bool _stepStarted; // results of the step are not taken yet
+    std::function<bool(PhysicsContact&)> _contactFilter;
+    std::vector<DeferredContact> _deferredContacts;
+    std::unordered_set<PhysicsContact*> _deferredPostSolve;
+    std::vector<PhysicsContact*> _separatedContacts; // separated while deferred events were dispatched
+    bool _dispatchingDeferred;
+    EventListenerCustom* _beforeUpdateListener;
     
     bool _updateBodyTransform;
     Vector<PhysicsBody*> _bodies;
+    std::vector<PhysicsBody*> _syncBodies; // marked to be synced by the next afterSimulation()
+    std::vector<PhysicsBody*> _syncedBodies;
+    std::vector<PhysicsBody*> _ownerBodies; // marked to have owner checked by the next beforeSimulation()
+    std::vector<PhysicsBody*> _checkedOwnerBodies;
+    unsigned int _syncStamp;
+    bool _syncingNodes; // afterSimulation() is writing body state to owners
     std::list<PhysicsJoint*> _joints;
     RefPtr<PhysicsForceField> _forceField;
+    // Awake bodies and their coordinates gathered for batch gravity evaluation, reused by every step
+    std::vector<PhysicsBody*> _fieldBodies;
+    std::vector<cpFloat> _fieldX;
+    std::vector<cpFloat> _fieldY;
+    std::vector<cpFloat> _fieldGX;
+    std::vector<cpFloat> _fieldGY;
+    // Scratch buffers of batch queries
+    std::vector<Rect> _batchBounds;
+    std::vector<uint64_t> _batchOrder;
+    std::vector<void*> _batchCandidates;
+    std::vector<std::pair<int, PhysicsShape*>> _batchFound;
     Scene* _scene;
     
     bool _autoStep;
@@ -407,8 +548,14 @@ protected:
     PhysicsWorld();
     virtual ~PhysicsWorld();
     
-    void beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation);
-    void afterSimulation(Node* node, const Mat4& parentToWorldTransform, float parentRotation);
+    // Sync of node and body transforms visits only bodies which may have moved instead of the whole scene graph
+    void beforeSimulation();
+    void afterSimulation();
+    void afterSimulation(PhysicsBody* body);
+    // Body is synced by the next afterSimulation() regardless of being awake. Owners are checked for changes
+    // by beforeSimulation() only if marked by Node transform setters, addBody() or enabling the body.
+    // Moving a parent of the owner is not noticed, move the owner or the body itself instead
+    void markBodyMoved(PhysicsBody* body);
 
     friend class Node;
     friend class Sprite;
@@ -0,0 +1,87 @@
+// Headless check that time warp does not change trajectories: the same world is stepped
+// at normal speed and at warp speeds for the same game time, positions of a ballistic
+// and an orbiting body must agree. No window or GL context is created
+
+#include "cocos2d.h"
+
+#include <cstdio>
+
+USING_NS_CC;
+
+static const int simulationRate = 128; // Power of two, so that frame time accumulates exactly
+static const float frameDelta = 1.0f / 64;
+static const float gameTime = 16.0f;
+static const float planetMass = 1e6f;
+static const float orbitRadius = 1000.0f;
+static const float tolerance = 1e-2f;
+
+struct Result {
+    Vec2 ballistic;
+    Vec2 orbiting;
+};
+
+static Node* addBody(Scene* scene, Vec2 position, Vec2 velocity)
+{
+    auto body = PhysicsBody::create(1.0f, 1.0f);
+    body->setVelocity(velocity);
+    auto node = Node::create();
+    node->setPosition(position);
+    node->setPhysicsBody(body);
+    scene->addChild(node);
+    return node;
+}
+
+static Result simulate(float speed)
+{
+    auto scene = Scene::createWithPhysics();
+    PhysicsWorld* world = scene->getPhysicsWorld();
+    world->setGravity(Vec2::ZERO);
+    world->setFixedUpdateRate(simulationRate);
+    world->setMaxFixedSteps(0);
+    world->setInterpolation(false);
+    world->setSpeed(speed);
+    auto ffield = PhysicsForceField::create();
+    world->setForceField(ffield);
+    scene->onEnter();
+
+    auto planet = addBody(scene, Vec2::ZERO, Vec2::ZERO);
+    planet->getPhysicsBody()->setDynamic(false);
+    ffield->addGravitySource(planet->getPhysicsBody(), planetMass);
+
+    float orbitSpeed = sqrtf(ffield->getGravityConstant() * planetMass / orbitRadius);
+    // Too slow to stay at its altitude, periapsis is still far from planet center where field is singular
+    auto ballistic = addBody(scene, Vec2(0.0f, 1.2f * orbitRadius), Vec2(0.8f * orbitSpeed, 0.0f));
+    auto orbiting = addBody(scene, Vec2(orbitRadius, 0.0f), Vec2(0.0f, orbitSpeed));
+
+    int frames = (int)(gameTime / speed / frameDelta);
+    for (int i = 0; i < frames; i++) {
+        scene->stepPhysicsAndNavigation(frameDelta);
+    }
+
+    Result result;
+    result.ballistic = ballistic->getPhysicsBody()->getPosition();
+    result.orbiting = orbiting->getPhysicsBody()->getPosition();
+    scene->onExit();
+    return result;
+}
+
+static bool check(const char* name, float speed, Vec2 expected, Vec2 actual)
+{
+    float error = expected.distance(actual);
+    bool ok = error <= tolerance;
+    printf("%s at %gx: (%g, %g) vs (%g, %g) at 1x, error %g%s\n", name, speed,
+           actual.x, actual.y, expected.x, expected.y, error, (ok? "": " FAILED"));
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    Result normal = simulate(1.0f);
+    bool ok = true;
+    for (float speed : { 2.0f, 4.0f, 16.0f }) {
+        Result warp = simulate(speed);
+        ok &= check("ballistic", speed, normal.ballistic, warp.ballistic);
+        ok &= check("orbiting", speed, normal.orbiting, warp.orbiting);
+    }
+    return ok? 0: 1;
+}